@@ -0,0 +1,320 @@
+#include "212609440_322776063_Boustrophedon.h"
+#include "../AlgorithmRegistration.h"
+#include "../../common/AlgorithmState.h"
+#include "../../common/Logger.h"
+#include <algorithm>
+#include <vector>
+
+Logger BoustrophedonAlgorithm::logger("boustrophedon_algorithm.log");
+
+namespace {
+
+constexpr Step kMoves[] = {Step::North, Step::East, Step::South, Step::West};
+
+std::tuple<int, int> neighbour(const std::tuple<int, int>& cell, Step step) {
+    int x = std::get<0>(cell);
+    int y = std::get<1>(cell);
+    switch (step) {
+        case Step::North: return std::make_tuple(x, y - 1);
+        case Step::East:  return std::make_tuple(x + 1, y);
+        case Step::South: return std::make_tuple(x, y + 1);
+        case Step::West:  return std::make_tuple(x - 1, y);
+        default: return cell;
+    }
+}
+
+Step opposite(Step step) {
+    switch (step) {
+        case Step::North: return Step::South;
+        case Step::East:  return Step::West;
+        case Step::South: return Step::North;
+        case Step::West:  return Step::East;
+        default: return step;
+    }
+}
+
+bool isHorizontal(Step step) {
+    return step == Step::East || step == Step::West;
+}
+
+std::string cellName(const std::tuple<int, int>& cell) {
+    return "(" + std::to_string(std::get<0>(cell)) + ", " + std::to_string(std::get<1>(cell)) + ")";
+}
+
+}  // namespace
+
+BoustrophedonAlgorithm::BoustrophedonAlgorithm() : dockingStation(std::make_tuple(0, 0)), currentPosition(dockingStation) {
+    logger.log(Logger::INFO, "BoustrophedonAlgorithm initialized");
+}
+
+void BoustrophedonAlgorithm::setDockingStation(int dockX, int dockY) {
+    dockingStation = std::make_tuple(dockX, dockY);
+    currentPosition = dockingStation;
+    logger.log(Logger::INFO, "Docking station set to (" + std::to_string(dockX) + ", " + std::to_string(dockY) + ")");
+}
+
+void BoustrophedonAlgorithm::setMaxSteps(std::size_t maxSteps) {
+    this->maxSteps = maxSteps;
+    chargingPlanner.setMaxSteps(maxSteps);
+    logger.log(Logger::INFO, "Max steps set to " + std::to_string(maxSteps));
+}
+
+void BoustrophedonAlgorithm::setWallsSensor(const WallsSensor& sensor) {
+    this->wallsSensor = &sensor;
+    logger.log(Logger::INFO, "Walls sensor set");
+}
+
+void BoustrophedonAlgorithm::setDirtSensor(const DirtSensor& sensor) {
+    this->dirtSensor = &sensor;
+    logger.log(Logger::INFO, "Dirt sensor set");
+}
+
+void BoustrophedonAlgorithm::setBatteryMeter(const BatteryMeter& meter) {
+    this->batteryMeter = &meter;
+    logger.log(Logger::INFO, "Battery meter set");
+}
+
+// The tunable parameters are the charging planner's
+bool BoustrophedonAlgorithm::setParameter(const std::string& name, double value) {
+    return chargingPlanner.setParameter(name, value, logger);
+}
+
+// Snapshot of everything learned so far: position, map with distances, sweep directions, the planned path and
+// the charging state
+std::string BoustrophedonAlgorithm::saveState() const {
+    StateWriter out("boustrophedon-state-2", dockingStation, currentPosition, isCharging, chargingPlanner);
+    out.put(sweepStep).put(advanceStep).put(plannedTarget);
+    out.sequence(plannedPath, [&](Step step) { out.put(step); });
+    out.sequence(internalMap, [&](const auto& entry) {
+        const Cell& info = entry.second;
+        out.put(entry.first).put(info.dirt).put(info.visited).put(info.distance);
+    });
+    return out.str();
+}
+
+bool BoustrophedonAlgorithm::restoreState(const std::string& state) {
+    StateReader in(state, "boustrophedon-state-2", dockingStation, currentPosition, isCharging, chargingPlanner);
+    if (!in.ok()) {
+        logger.log(Logger::ERROR, "Cannot restore algorithm state");
+        return false;
+    }
+    plannedPath.clear();
+    internalMap.clear();
+    using CellEntry = std::tuple<std::tuple<int, int>, int, bool, int>;
+    if (!in.get(sweepStep) || !in.get(advanceStep) || !in.get(plannedTarget) ||
+        !in.sequence<Step>([&](Step step) { plannedPath.push_back(step); }) ||
+        !in.sequence<CellEntry>([&](const CellEntry& entry) {
+            const auto& [cell, dirt, visited, distance] = entry;
+            internalMap[cell] = Cell{dirt, visited, distance};
+        })) {
+        return false;
+    }
+    logger.log(Logger::INFO, "Restored algorithm state at " + cellName(currentPosition));
+    return true;
+}
+
+Step BoustrophedonAlgorithm::nextStep() {
+    int x = std::get<0>(currentPosition);
+    int y = std::get<1>(currentPosition);
+
+    // The dock is never dirty; its sensor reading is not a dirt level
+    bool inDock = currentPosition == dockingStation;
+    int currentDirtLevel = inDock ? 0 : dirtSensor->dirtLevel();
+    updateInternalMap(x, y, currentDirtLevel);
+    const Cell& here = internalMap[currentPosition];
+    auto distance = static_cast<std::size_t>(here.distance);
+
+    std::size_t battery = batteryMeter->getBatteryState();
+    chargingPlanner.beginStep(battery);
+
+    if (isCharging) {
+        if (!inDock) {
+            return stepTowardsDock();
+        }
+
+        if (!chargingPlanner.worthLeavingDock() || !hasReachablePending()) {
+            logger.log(Logger::INFO, "Nothing left that a trip from the docking station can clean, finishing");
+            return Step::Finish;
+        }
+
+        // Charge only as much as the next excursion can use, which is no more than the dirt left needs
+        std::size_t excursion = remainingWork();
+        if (!chargingPlanner.chargingComplete(battery, excursion)) {
+            logger.log(Logger::INFO, "Charging at docking station, steps remaining: " + std::to_string(chargingPlanner.chargeStepsNeeded(battery, excursion)));
+            return Step::Stay;
+        }
+
+        isCharging = false;
+        plannedPath.clear();
+        logger.log(Logger::INFO, "Charged enough with battery " + std::to_string(battery) + ", resuming the sweep");
+    }
+
+    if (currentDirtLevel > 0 && chargingPlanner.canAfford(battery, 1, distance)) {
+        logger.log(Logger::INFO, "Staying to clean dirt " + std::to_string(currentDirtLevel) + " at " + cellName(currentPosition));
+        return Step::Stay;
+    }
+
+    // On the way to the next cell of the decomposition, as long as it still needs a visit the battery allows
+    if (!plannedPath.empty()) {
+        const Cell& target = internalMap[plannedTarget];
+        if (isPending(target) && chargingPlanner.canAfford(battery, plannedPath.size() + 1, static_cast<std::size_t>(target.distance))) {
+            Step step = plannedPath.front();
+            plannedPath.pop_front();
+            return move(step);
+        }
+        plannedPath.clear();
+    }
+
+    // Along the row first, then on to the next row turning back, then the other way
+    for (Step step : {sweepStep, advanceStep, opposite(advanceStep), opposite(sweepStep)}) {
+        auto next = internalMap.find(neighbour(currentPosition, step));
+        if (next == internalMap.end() || !isPending(next->second) ||
+            !chargingPlanner.canAfford(battery, 2, static_cast<std::size_t>(next->second.distance))) {
+            continue;
+        }
+        if (!isHorizontal(step)) {
+            sweepStep = opposite(sweepStep);
+        } else {
+            sweepStep = step;
+        }
+        return move(step);
+    }
+
+    // The row is done: start the nearest cell still waiting for a sweep
+    if (planPath(battery)) {
+        logger.log(Logger::INFO, "Heading to " + cellName(plannedTarget) + ", " + std::to_string(plannedPath.size()) + " steps away");
+        Step step = plannedPath.front();
+        plannedPath.pop_front();
+        return move(step);
+    }
+
+    // Nothing the battery can reach from here: recharge, unless charging would not help either
+    if (inDock && chargingPlanner.chargingComplete(battery, remainingWork())) {
+        logger.log(Logger::INFO, "Reached docking station after cleaning all what's reachable, finishing simulation");
+        return Step::Finish;
+    }
+    isCharging = true;
+    logger.log(Logger::INFO, "Returning to docking station with battery " + std::to_string(battery) + " from distance " + std::to_string(distance));
+    return inDock ? Step::Stay : stepTowardsDock();
+}
+
+// Records the current cell and the free cells around it. A new cell can shorten the way back for cells
+// already known, so the distances are relaxed from it.
+void BoustrophedonAlgorithm::updateInternalMap(int x, int y, int dirtLevel) {
+    if (internalMap.empty()) {
+        internalMap[dockingStation] = Cell{0, true, 0};
+    }
+    Cell& here = internalMap[std::make_tuple(x, y)];
+    here.dirt = dirtLevel;
+    here.visited = true;
+
+    for (Step step : kMoves) {
+        if (wallsSensor->isWall(static_cast<Direction>(step))) {
+            continue;
+        }
+        auto cell = neighbour(currentPosition, step);
+        if (internalMap.count(cell) != 0) {
+            continue;
+        }
+        int best = -1;
+        for (Step around : kMoves) {
+            auto known = internalMap.find(neighbour(cell, around));
+            if (known != internalMap.end() && (best < 0 || known->second.distance < best)) {
+                best = known->second.distance;
+            }
+        }
+        internalMap[cell] = Cell{-1, false, best + 1};
+        relaxDistances(cell);
+    }
+}
+
+void BoustrophedonAlgorithm::relaxDistances(const std::tuple<int, int>& from) {
+    std::deque<std::tuple<int, int>> queue{from};
+    while (!queue.empty()) {
+        auto cell = queue.front();
+        queue.pop_front();
+        int distance = internalMap[cell].distance;
+        for (Step step : kMoves) {
+            auto next = internalMap.find(neighbour(cell, step));
+            if (next != internalMap.end() && next->second.distance > distance + 1) {
+                next->second.distance = distance + 1;
+                queue.push_back(next->first);
+            }
+        }
+    }
+}
+
+// Whether a trip from the docking station on a full battery could clean any of the cells still pending
+bool BoustrophedonAlgorithm::hasReachablePending() const {
+    std::size_t capacity = chargingPlanner.capacity();
+    return std::any_of(internalMap.begin(), internalMap.end(), [&](const auto& entry) {
+        auto distance = static_cast<std::size_t>(entry.second.distance);
+        return isPending(entry.second) && capacity >= 2 * distance + 1;
+    });
+}
+
+// Steps an excursion needs at most for the dirt left, once the whole reachable map is known: going to each dirty
+// cell, cleaning it and coming back. Always stepping to the nearest dirty cell costs no more than that, so the
+// excursion never runs short. While cells are still unexplored its length is unknown and 0 is returned.
+std::size_t BoustrophedonAlgorithm::remainingWork() const {
+    std::size_t work = 0;
+    for (const auto& [cell, info] : internalMap) {
+        if (!info.visited) {
+            return 0;
+        }
+        if (info.dirt > 0) {
+            work += 2 * static_cast<std::size_t>(info.distance) + static_cast<std::size_t>(info.dirt);
+        }
+    }
+    return work;
+}
+
+// Breadth-first search over the known free cells for the nearest pending cell the battery can reach, clean
+// and come back from. Ties go to the sweep order, so the next sweep starts where the last one left off.
+bool BoustrophedonAlgorithm::planPath(std::size_t battery) {
+    std::unordered_map<std::tuple<int, int>, std::tuple<std::tuple<int, int>, Step>, CellHash> cameFrom;
+    std::vector<std::tuple<int, int>> queue{currentPosition};
+    cameFrom[currentPosition] = std::make_tuple(currentPosition, Step::Stay);
+    std::vector<std::size_t> lengths{0};
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        auto cell = queue[head];
+        std::size_t length = lengths[head];
+        const Cell& info = internalMap.at(cell);
+        if (length > 0 && isPending(info) && chargingPlanner.canAfford(battery, length + 1, static_cast<std::size_t>(info.distance))) {
+            plannedTarget = cell;
+            plannedPath.clear();
+            for (auto at = cell; at != currentPosition; at = std::get<0>(cameFrom[at])) {
+                plannedPath.push_front(std::get<1>(cameFrom[at]));
+            }
+            return true;
+        }
+        for (Step step : {sweepStep, advanceStep, opposite(advanceStep), opposite(sweepStep)}) {
+            auto next = neighbour(cell, step);
+            if (internalMap.count(next) != 0 && cameFrom.count(next) == 0) {
+                cameFrom[next] = std::make_tuple(cell, step);
+                queue.push_back(next);
+                lengths.push_back(length + 1);
+            }
+        }
+    }
+    return false;
+}
+
+Step BoustrophedonAlgorithm::stepTowardsDock() {
+    int distance = internalMap[currentPosition].distance;
+    for (Step step : kMoves) {
+        auto next = internalMap.find(neighbour(currentPosition, step));
+        if (next != internalMap.end() && next->second.distance == distance - 1) {
+            return move(step);
+        }
+    }
+    return Step::Stay;
+}
+
+Step BoustrophedonAlgorithm::move(Step step) {
+    currentPosition = neighbour(currentPosition, step);
+    logger.log(Logger::INFO, "Moving " + std::to_string(static_cast<int>(step)) + " to " + cellName(currentPosition));
+    return step;
+}
+
+REGISTER_ALGORITHM(BoustrophedonAlgorithm);
@@ -0,0 +1,77 @@
+#ifndef BOUSTROPHEDON_ALGORITHM_H_
+#define BOUSTROPHEDON_ALGORITHM_H_
+
+#include "../../common/ParameterizedAlgorithm.h"
+#include "../../common/SnapshotAlgorithm.h"
+#include "../../common/WallSensor.h"
+#include "../../common/DirtSensor.h"
+#include "../../common/BatteryMeter.h"
+#include "../../common/Logger.h"
+#include "../../common/ChargingPlanner.h"
+#include <deque>
+#include <tuple>
+#include <unordered_map>
+
+// Online boustrophedon coverage: sweeps back and forth along the rows of the free space discovered so far,
+// stepping to the next row at the end of each one. Whatever a sweep leaves out (the far side of an obstacle,
+// rows behind the docking station) is a separate cell of the decomposition and is reached over a shortest
+// path through the known map, as are cells still dirty after a return to the dock. The distance to the dock
+// of every known cell is kept up to date, so the robot goes only as far as its battery can bring it back from
+// and returns by the shortest way instead of retracing its path.
+class BoustrophedonAlgorithm : public ParameterizedAlgorithm, public SnapshotAlgorithm {
+public:
+    BoustrophedonAlgorithm();
+
+    void setDockingStation(int dockX, int dockY);
+    void setMaxSteps(std::size_t maxSteps) override;
+    void setWallsSensor(const WallsSensor& sensor) override;
+    void setDirtSensor(const DirtSensor& sensor) override;
+    void setBatteryMeter(const BatteryMeter& meter) override;
+    bool setParameter(const std::string& name, double value) override;
+    std::string saveState() const override;
+    bool restoreState(const std::string& state) override;
+
+    Step nextStep() override;
+
+private:
+    struct Cell {
+        int dirt = -1;          // Unknown until visited
+        bool visited = false;
+        int distance = 0;       // Shortest known path to the docking station
+    };
+
+    struct CellHash {
+        std::size_t operator()(const std::tuple<int, int>& cell) const {
+            return std::hash<long long>{}((static_cast<long long>(std::get<0>(cell)) << 32) ^ static_cast<unsigned int>(std::get<1>(cell)));
+        }
+    };
+
+    using CellMap = std::unordered_map<std::tuple<int, int>, Cell, CellHash>;
+
+    void updateInternalMap(int x, int y, int dirtLevel);
+    void relaxDistances(const std::tuple<int, int>& from);
+    static bool isPending(const Cell& cell) { return !cell.visited || cell.dirt > 0; }
+    bool hasReachablePending() const;
+    std::size_t remainingWork() const;
+    bool planPath(std::size_t battery);
+    Step stepTowardsDock();
+    Step move(Step step);
+
+    CellMap internalMap;
+    std::deque<Step> plannedPath;  // Steps to plannedTarget, the next cell of the decomposition
+    std::tuple<int, int> plannedTarget;
+    Step sweepStep = Step::East;    // Direction along the current row
+    Step advanceStep = Step::South; // Direction to the next row
+    std::tuple<int, int> dockingStation;
+    std::tuple<int, int> currentPosition;
+    std::size_t maxSteps = 0;
+    const WallsSensor* wallsSensor = nullptr;
+    const DirtSensor* dirtSensor = nullptr;
+    const BatteryMeter* batteryMeter = nullptr;
+    bool isCharging = false;
+    ChargingPlanner chargingPlanner;  // Decides when charging is enough and whether a trip can still return
+
+    static Logger logger;
+};
+
+#endif  // BOUSTROPHEDON_ALGORITHM_H_
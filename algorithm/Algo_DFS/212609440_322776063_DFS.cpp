@@ -1,6 +1,8 @@
 #include "212609440_322776063_DFS.h"
 #include "../AlgorithmRegistration.h"
+#include "../../common/AlgorithmState.h"
 #include "../../common/Logger.h"
+#include <algorithm>
 
 Logger DFSAlgorithm::logger("dfs_algorithm.log");
 
@@ -16,6 +18,7 @@ void DFSAlgorithm::setDockingStation(int dockX, int dockY) {
 
 void DFSAlgorithm::setMaxSteps(std::size_t maxSteps) {
     this->maxSteps = maxSteps;
+    chargingPlanner.setMaxSteps(maxSteps);
     logger.log(Logger::INFO, "Max steps set to " + std::to_string(maxSteps));
 }
 
@@ -34,6 +37,50 @@ void DFSAlgorithm::setBatteryMeter(const BatteryMeter& meter) {
     logger.log(Logger::INFO, "Battery meter set");
 }
 
+// The tunable parameters are the charging planner's
+bool DFSAlgorithm::setParameter(const std::string& name, double value) {
+    return chargingPlanner.setParameter(name, value, logger);
+}
+
+// Snapshot of everything learned so far: position, map, path back to the dock and the charging state
+std::string DFSAlgorithm::saveState() const {
+    StateWriter out("dfs-state-2", dockingStation, currentPosition, isCharging, chargingPlanner);
+    out.sequence(pathToDocking, [&](Step step) { out.put(step); });
+    out.sequence(visited, [&](const auto& cell) { out.put(cell); });
+    out.sequence(internalMap, [&](const auto& entry) { out.put(entry); });
+    out.sequence(frontier, [&](const auto& cell) { out.put(cell); });
+    // The stack bottom first
+    std::vector<Step> stack;
+    for (auto copy = dfsStack; !copy.empty(); copy.pop()) {
+        stack.push_back(copy.top());
+    }
+    std::reverse(stack.begin(), stack.end());
+    out.sequence(stack, [&](Step step) { out.put(step); });
+    return out.str();
+}
+
+bool DFSAlgorithm::restoreState(const std::string& state) {
+    StateReader in(state, "dfs-state-2", dockingStation, currentPosition, isCharging, chargingPlanner);
+    if (!in.ok()) {
+        logger.log(Logger::ERROR, "Cannot restore algorithm state");
+        return false;
+    }
+    pathToDocking.clear();
+    visited.clear();
+    internalMap.clear();
+    frontier.clear();
+    dfsStack = {};
+    if (!in.sequence<Step>([&](Step step) { pathToDocking.push_back(step); }) ||
+        !in.sequence<std::tuple<int, int>>([&](const auto& cell) { visited.insert(cell); }) ||
+        !in.sequence<std::pair<std::tuple<int, int>, int>>([&](const auto& entry) { internalMap.insert(entry); }) ||
+        !in.sequence<std::tuple<int, int>>([&](const auto& cell) { frontier.insert(cell); }) ||
+        !in.sequence<Step>([&](Step step) { dfsStack.push(step); })) {
+        return false;
+    }
+    logger.log(Logger::INFO, "Restored algorithm state at (" + std::to_string(std::get<0>(currentPosition)) + ", " + std::to_string(std::get<1>(currentPosition)) + ")");
+    return true;
+}
+
 Step DFSAlgorithm::nextStep() {
     if (dfsStack.empty()) {
         logger.log(Logger::INFO, "DFS exloring starts from docking station");
@@ -46,35 +93,43 @@ Step DFSAlgorithm::nextStep() {
 
     int currentDirtLevel = dirtSensor->dirtLevel();
     updateInternalMap(x, y, currentDirtLevel);
+    updateFrontier(x, y);
     logger.log(Logger::INFO, "Currently in position (" + std::to_string(x) + ", " + std::to_string(y) + "), dirt level: " + std::to_string(currentDirtLevel));
 
 
-    // If battery is low or we're currently charging, return to docking
-    if (isCharging || batteryMeter->getBatteryState() <= pathToDocking.size()) {
-        if (!isCharging) {
-            isCharging=true;
-            chargeStepsRemaining=20;
+    std::size_t battery = batteryMeter->getBatteryState();
+    chargingPlanner.beginStep(battery);
+
+    // If battery or remaining steps are low, or we're currently charging, return to docking
+    if (isCharging || chargingPlanner.shouldReturn(battery, pathToDocking.size())) {
+        isCharging = true;
+
+        if (!pathToDocking.empty()) {
+            return calculateReturnPath();
+        }
+
+        if (!chargingPlanner.worthLeavingDock()) {
+            logger.log(Logger::INFO, "Not enough steps left for another excursion, finishing at docking station");
+            return Step::Finish;
+        }
+
+        if (frontier.empty() && dirtLastSeen() == 0) {
+            logger.log(Logger::INFO, "Every reachable cell was visited and left clean, finishing at docking station");
+            return Step::Finish;
         }
-        
-        // Continue charging if necessary
-        if (isCharging) {
-            if(pathToDocking.empty()==true){
-                logger.log(Logger::INFO, "Charging at docking station, steps remaining: " + std::to_string(chargeStepsRemaining));
-                chargeStepsRemaining--;
-                if(chargeStepsRemaining==0){
-                    isCharging = false;
-                    visited.clear();
-                    while (!dfsStack.empty()) {dfsStack.pop();}
-                    logger.log(Logger::INFO, "Last step of charging,then resuming DFS exploration");
-                }
-                return Step::Stay;
-            }
-            else{
-                return calculateReturnPath();
-            }
+
+        // Charge only as much as the next excursion can use
+        std::size_t excursion = knownExcursion();
+        if (!chargingPlanner.chargingComplete(battery, excursion)) {
+            logger.log(Logger::INFO, "Charging at docking station, steps remaining: " + std::to_string(chargingPlanner.chargeStepsNeeded(battery, excursion)));
+            return Step::Stay;
         }
 
-        return calculateReturnPath();
+        isCharging = false;
+        visited.clear();
+        while (!dfsStack.empty()) {dfsStack.pop();}
+        visited.insert(currentPosition);
+        logger.log(Logger::INFO, "Charged enough with battery " + std::to_string(battery) + ", resuming DFS exploration");
     }
 
     if (currentDirtLevel > 0) {
@@ -126,6 +181,37 @@ void DFSAlgorithm::updateInternalMap(int x, int y, int dirtLevel) {
     logger.log(Logger::INFO, "Updated internal map at position (" + std::to_string(x) + ", " + std::to_string(y) + ") with dirt level " + std::to_string(dirtLevel));
 }
 
+// Cells seen open from here that were never visited are the frontier of the known house
+void DFSAlgorithm::updateFrontier(int x, int y) {
+    frontier.erase(std::make_tuple(x, y));
+    const std::pair<Direction, std::tuple<int, int>> neighbours[] = {
+        {Direction::North, {x, y - 1}}, {Direction::East, {x + 1, y}}, {Direction::South, {x, y + 1}}, {Direction::West, {x - 1, y}}};
+    for (const auto& [direction, cell] : neighbours) {
+        if (!wallsSensor->isWall(direction) && internalMap.find(cell) == internalMap.end()) {
+            frontier.insert(cell);
+        }
+    }
+}
+
+// Steps the next excursion can take at most. With no frontier left the depth-first walk from the dock stays on
+// known cells and goes out and back along each of them at most once, and it Stays no more than the dirt last seen.
+// While the frontier is not empty the excursion goes on into unknown cells and its length is not known (0).
+std::size_t DFSAlgorithm::knownExcursion() const {
+    if (!frontier.empty() || internalMap.empty()) {
+        return 0;
+    }
+    return 2 * (internalMap.size() - 1) + dirtLastSeen();
+}
+
+// Dirt only goes down, so this is at least the dirt left in the cells visited so far
+std::size_t DFSAlgorithm::dirtLastSeen() const {
+    std::size_t dirt = 0;
+    for (const auto& [cell, level] : internalMap) {
+        dirt += static_cast<std::size_t>(std::max(level, 0));
+    }
+    return dirt;
+}
+
 Step DFSAlgorithm::calculateReturnPath() {
     if (!pathToDocking.empty()) {
         Step lastStep = pathToDocking.back();
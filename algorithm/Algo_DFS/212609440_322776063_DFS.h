@@ -1,11 +1,13 @@
 #ifndef DFS_ALGORITHM_H
 #define DFS_ALGORITHM_H
 
-#include "../../common/AbstractAlgorithm.h"
+#include "../../common/ParameterizedAlgorithm.h"
+#include "../../common/SnapshotAlgorithm.h"
 #include "../../common/WallSensor.h"
 #include "../../common/DirtSensor.h"
 #include "../../common/BatteryMeter.h"
 #include "../../common/Logger.h"
+#include "../../common/ChargingPlanner.h"
 #include <stack>
 #include <unordered_set>
 #include <unordered_map>
@@ -24,7 +26,7 @@ namespace std {
     };
 }
 
-class DFSAlgorithm : public AbstractAlgorithm {
+class DFSAlgorithm : public ParameterizedAlgorithm, public SnapshotAlgorithm {
 public:
     DFSAlgorithm();
 
@@ -33,17 +35,24 @@ public:
     void setWallsSensor(const WallsSensor& sensor) override;
     void setDirtSensor(const DirtSensor& sensor) override;
     void setBatteryMeter(const BatteryMeter& meter) override;
+    bool setParameter(const std::string& name, double value) override;
+    std::string saveState() const override;
+    bool restoreState(const std::string& state) override;
 
     Step nextStep() override;
 
 private:
     void updateInternalMap(int x, int y, int dirtLevel);
+    void updateFrontier(int x, int y);
+    std::size_t dirtLastSeen() const;
+    std::size_t knownExcursion() const;
     Step calculateReturnPath();
 
     std::stack<Step> dfsStack;
     std::vector<Step> pathToDocking;
     std::unordered_set<std::tuple<int, int>> visited;
     std::unordered_map<std::tuple<int, int>, int> internalMap;
+    std::unordered_set<std::tuple<int, int>> frontier;  // Open cells next to visited ones, never visited themselves
     std::tuple<int, int> dockingStation;
     std::tuple<int, int> currentPosition;
     std::size_t maxSteps;
@@ -51,7 +60,7 @@ private:
     const DirtSensor* dirtSensor;
     const BatteryMeter* batteryMeter;
     bool isCharging = false;
-    int chargeStepsRemaining = 20;  // Number of steps to stay in the docking station for charging
+    ChargingPlanner chargingPlanner;  // Decides when to return to the docking station and when charging is enough
 
     static Logger logger;
 };
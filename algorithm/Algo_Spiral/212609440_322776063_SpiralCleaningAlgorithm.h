@@ -1,21 +1,24 @@
 #ifndef SPIRAL_CLEANING_ALGORITHM_H_
 #define SPIRAL_CLEANING_ALGORITHM_H_
 
-#include "../../common/AbstractAlgorithm.h"
+#include "../../common/ParameterizedAlgorithm.h"
+#include "../../common/SnapshotAlgorithm.h"
 #include "../../common/WallSensor.h"
 #include "../../common/DirtSensor.h"
 #include "../../common/BatteryMeter.h"
 #include "../../common/Logger.h"
+#include "../../common/ChargingPlanner.h"
 #include <set>
 #include <tuple>
 #include <vector>
 #include <map>
 
-class SpiralCleaningAlgorithm : public AbstractAlgorithm {
+class SpiralCleaningAlgorithm : public ParameterizedAlgorithm, public SnapshotAlgorithm {
 private:
     std::set<std::tuple<int, int>> visited;
     std::vector<Step> pathToDocking;
     std::map<std::tuple<int, int>, int> internalMap;
+    std::set<std::tuple<int, int>> frontier;  // Open cells next to visited ones, never visited themselves
     const DirtSensor* dirtSensor = nullptr;
     const WallsSensor* wallsSensor = nullptr;
     const BatteryMeter* batteryMeter = nullptr;
@@ -23,7 +26,7 @@ private:
     std::tuple<int, int> dockingStation;
     std::tuple<int, int> currentPosition;
     bool isCharging = false;
-    int chargeStepsRemaining = 20;  // Number of steps to stay in the docking station for charging
+    ChargingPlanner chargingPlanner;  // Decides when to return to the docking station and when charging is enough
 
     static Logger logger;
 
@@ -34,10 +37,16 @@ public:
     void setWallsSensor(const WallsSensor& sensor) override;
     void setDirtSensor(const DirtSensor& sensor) override;
     void setBatteryMeter(const BatteryMeter& meter) override;
+    bool setParameter(const std::string& name, double value) override;
+    std::string saveState() const override;
+    bool restoreState(const std::string& state) override;
     Step nextStep() override;
 
 private:
     void updateInternalMap(int x, int y, int dirtLevel);
+    void updateFrontier(int x, int y);
+    std::size_t dirtLastSeen() const;
+    std::size_t knownExcursion() const;
     Step calculateReturnPath();
 };
 
@@ -12,6 +12,10 @@ struct AlgorithmRegistration {
     }
 };
 
+// Lets the simulator check which interface version a plugin was built against before using it.
+// Weak, so every translation unit of a plugin may include this header.
+extern "C" __attribute__((weak)) int algorithm_abi_version() { return ALGORITHM_ABI_VERSION; }
+
 #define REGISTER_ALGORITHM(ALGO) AlgorithmRegistration \
    _##ALGO(#ALGO, []{return std::make_unique<ALGO>();})
 
@@ -1,6 +1,7 @@
 #ifndef ALGO_REGISTRAR__
 #define ALGO_REGISTRAR__
 
+#include<algorithm>
 #include<string>
 #include<memory>
 #include<vector>
@@ -8,6 +9,10 @@
 
 #include "AbstractAlgorithm.h"
 
+// Version of the plugin interface (AbstractAlgorithm and the registration protocol).
+// Plugins report the version they were built against through algorithm_abi_version().
+#define ALGORITHM_ABI_VERSION 1
+
 using AlgorithmFactory = std::function<std::unique_ptr<AbstractAlgorithm>()>;
 
 class AlgorithmRegistrar {
@@ -37,6 +42,18 @@ public:
     auto end() const { return algorithms.end(); }
     std::size_t count() const { return algorithms.size(); }
     void clear() { algorithms.clear(); }
+    // Drops the registrations made from position `index` on, e.g. by a plugin that is being rejected
+    void eraseFrom(std::size_t index) {
+        if (index < algorithms.size()) {
+            algorithms.erase(algorithms.begin() + index, algorithms.end());
+        }
+    }
+    // Drops the registration of one algorithm, e.g. before the library that provides it is unloaded
+    void unregisterAlgorithm(const std::string& name) {
+        algorithms.erase(std::remove_if(algorithms.begin(), algorithms.end(),
+                                        [&](const AlgorithmFactoryPair& pair) { return pair.name() == name; }),
+                         algorithms.end());
+    }
 };
 
 #endif  // ALGO_REGISTRAR__
@@ -0,0 +1,119 @@
+#ifndef ALGORITHM_STATE_H
+#define ALGORITHM_STATE_H
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ChargingPlanner.h"
+#include "enums.h"
+
+// The framing of the state blobs of SnapshotAlgorithm, shared by the algorithms: plain text starting with a tag,
+// the docking station, the position, whether the robot is charging and the ChargingPlanner's state, followed by
+// the algorithm's own fields. Values are integers, Steps, and pairs and tuples of them; a sequence is its count
+// followed by that many entries.
+class StateWriter {
+public:
+    StateWriter(const std::string& tag, const std::tuple<int, int>& dockingStation, const std::tuple<int, int>& position,
+                bool charging, const ChargingPlanner& planner) {
+        out << tag << ' ';
+        put(dockingStation).put(position).put(charging);
+        planner.saveState(out);
+    }
+
+    template <typename T>
+    StateWriter& put(const T& value) {
+        if constexpr (std::is_same_v<T, Step>) {
+            out << static_cast<int>(value) << ' ';
+        } else if constexpr (std::is_same_v<T, bool>) {
+            out << (value ? 1 : 0) << ' ';
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            out << value << ' ';
+        } else {
+            std::apply([this](const auto&... fields) { (put(fields), ...); }, value);
+        }
+        return *this;
+    }
+
+    // The entries of `container` in its iteration order, each written by `writeEntry(entry)`
+    template <typename Container, typename WriteEntry>
+    StateWriter& sequence(const Container& container, WriteEntry writeEntry) {
+        put(container.size());
+        for (const auto& entry : container) {
+            writeEntry(entry);
+        }
+        return *this;
+    }
+
+    std::string str() const { return out.str(); }
+
+private:
+    std::ostringstream out;
+};
+
+class StateReader {
+public:
+    // Reads the header and, only if it is complete and carries `tag`, applies it to the arguments
+    StateReader(const std::string& state, const std::string& tag, std::tuple<int, int>& dockingStation,
+                std::tuple<int, int>& position, bool& charging, ChargingPlanner& planner)
+        : in(state) {
+        std::string readTag;
+        std::tuple<int, int> dock;
+        std::tuple<int, int> at;
+        bool isCharging = false;
+        ChargingPlanner restored = planner;
+        good = static_cast<bool>(in >> readTag) && readTag == tag && get(dock) && get(at) && get(isCharging) &&
+               restored.restoreState(in);
+        if (good) {
+            dockingStation = dock;
+            position = at;
+            charging = isCharging;
+            planner = restored;
+        }
+    }
+
+    // False once anything could not be read, including the header
+    bool ok() const { return good; }
+
+    template <typename T>
+    bool get(T& value) {
+        if constexpr (std::is_same_v<T, Step> || std::is_same_v<T, bool>) {
+            int number = 0;
+            good = good && static_cast<bool>(in >> number);
+            if (good) {
+                value = static_cast<T>(number);
+            }
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            good = good && static_cast<bool>(in >> value);
+        } else {
+            std::apply([this](auto&... fields) { (get(fields), ...); }, value);
+        }
+        return good;
+    }
+
+    // A sequence written by StateWriter::sequence, each entry read as an Entry and handed to `use(entry)`
+    template <typename Entry, typename Use>
+    bool sequence(Use use) {
+        std::size_t count = 0;
+        if (!get(count)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            Entry entry{};
+            if (!get(entry)) {
+                return false;
+            }
+            use(std::move(entry));
+        }
+        return true;
+    }
+
+private:
+    std::istringstream in;
+    bool good = true;
+};
+
+#endif // ALGORITHM_STATE_H
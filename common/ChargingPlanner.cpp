@@ -0,0 +1,99 @@
+#include "ChargingPlanner.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ChargingPlanner::setMaxSteps(std::size_t maxSteps) {
+    this->maxSteps = maxSteps;
+}
+
+void ChargingPlanner::setReturnMargin(std::size_t margin) {
+    returnMargin = margin;
+}
+
+void ChargingPlanner::setChargeFraction(double fraction) {
+    chargeFraction = std::clamp(fraction, 0.0, 1.0);
+}
+
+bool ChargingPlanner::setParameter(const std::string& name, double value, Logger& logger) {
+    if (name == "returnMargin") {
+        setReturnMargin(static_cast<std::size_t>(std::max(0.0, value)));
+    } else if (name == "chargeFraction") {
+        setChargeFraction(value);
+    } else {
+        logger.log(Logger::WARNING, "Unknown parameter " + name);
+        return false;
+    }
+    logger.log(Logger::INFO, "Parameter " + name + " set to " + std::to_string(value));
+    return true;
+}
+
+void ChargingPlanner::beginStep(std::size_t batteryState) {
+    if (stepsStarted == 0) {
+        batteryCapacity = batteryState;
+    }
+    stepsStarted++;
+}
+
+std::size_t ChargingPlanner::chargePerStep() const {
+    return std::max<std::size_t>(1, batteryCapacity / 20);
+}
+
+std::size_t ChargingPlanner::remainingSteps() const {
+    std::size_t used = stepsStarted > 0 ? stepsStarted - 1 : 0;
+    return maxSteps > used ? maxSteps - used : 0;
+}
+
+bool ChargingPlanner::shouldReturn(std::size_t batteryState, std::size_t distanceToDock) const {
+    if (distanceToDock == 0) {
+        return false;
+    }
+    // One more step away needs one more step back, so return while the remaining steps still cover the way home
+    return batteryState <= distanceToDock + returnMargin || remainingSteps() <= distanceToDock + 1;
+}
+
+bool ChargingPlanner::canAfford(std::size_t batteryState, std::size_t stepsAway, std::size_t distanceFromThere) const {
+    return batteryState >= stepsAway + distanceFromThere + returnMargin && remainingSteps() >= stepsAway + distanceFromThere;
+}
+
+std::size_t ChargingPlanner::requiredCharge(std::size_t excursionSteps) const {
+    // Never less than what it takes to get past the return margin, or the robot would bounce at the dock
+    std::size_t target = std::max<std::size_t>(returnMargin + 2, static_cast<std::size_t>(std::ceil(batteryCapacity * chargeFraction)));
+    std::size_t required = std::min({batteryCapacity, target, remainingSteps()});
+    if (excursionSteps > 0) {
+        // The return margin is kept on top of a known excursion too
+        required = std::min(required, excursionSteps + returnMargin);
+    }
+    return required;
+}
+
+bool ChargingPlanner::chargingComplete(std::size_t batteryState, std::size_t excursionSteps) const {
+    return batteryState >= requiredCharge(excursionSteps);
+}
+
+bool ChargingPlanner::worthLeavingDock() const {
+    // Step out, clean at least once, step back
+    return remainingSteps() >= 3;
+}
+
+std::size_t ChargingPlanner::chargeStepsNeeded(std::size_t batteryState, std::size_t excursionSteps) const {
+    // Each Stay adds chargePerStep() but also uses up one of the remaining steps the charge is compared against
+    std::size_t steps = 0;
+    std::size_t battery = batteryState;
+    std::size_t remaining = remainingSteps();
+    while (remaining > 0 && battery < std::min(requiredCharge(excursionSteps), remaining)) {
+        battery = std::min(batteryCapacity, battery + chargePerStep());
+        remaining--;
+        steps++;
+    }
+    return steps;
+}
+
+void ChargingPlanner::saveState(std::ostream& out) const {
+    out << batteryCapacity << ' ' << stepsStarted << ' ';
+}
+
+bool ChargingPlanner::restoreState(std::istream& in) {
+    return static_cast<bool>(in >> batteryCapacity >> stepsStarted);
+}
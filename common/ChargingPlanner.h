@@ -0,0 +1,62 @@
+#ifndef CHARGING_PLANNER_H
+#define CHARGING_PLANNER_H
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+
+class Logger;
+
+// Shared by the algorithms to decide when to head back to the docking station and how long to charge there.
+// The simulator charges max(1, maxBattery / 20) per Stay in the dock, so instead of sitting in the dock for a
+// fixed number of steps the robot leaves as soon as its battery covers the next excursion, which can never be
+// longer than the battery capacity or the steps left in the run.
+class ChargingPlanner {
+public:
+    void setMaxSteps(std::size_t maxSteps);
+    // Extra battery kept on top of the distance to the dock before turning back
+    void setReturnMargin(std::size_t margin);
+    // Fraction of the capacity an excursion is allowed to require, in (0, 1]
+    void setChargeFraction(double fraction);
+    // The settings above as the parameters of a sweep, for ParameterizedAlgorithm::setParameter:
+    //   returnMargin   - extra battery kept on top of the way back before returning to the docking station
+    //   chargeFraction - fraction of the battery capacity to charge before leaving the docking station
+    // Logs the setting, or a warning for a name it does not know, which it rejects
+    bool setParameter(const std::string& name, double value, Logger& logger);
+
+    // Called once at the start of every nextStep(). The battery is full on the first call, which gives the capacity.
+    void beginStep(std::size_t batteryState);
+
+    std::size_t capacity() const { return batteryCapacity; }
+    std::size_t chargePerStep() const;
+    // Steps left in the run, counting the one being decided
+    std::size_t remainingSteps() const;
+
+    // True when the robot, `distanceToDock` steps away, has to start heading back now
+    bool shouldReturn(std::size_t batteryState, std::size_t distanceToDock) const;
+    // True when the robot can spend `stepsAway` more steps and still make it back from a cell `distanceFromThere`
+    // steps from the dock, with the return margin kept, before the battery or the run ends
+    bool canAfford(std::size_t batteryState, std::size_t stepsAway, std::size_t distanceFromThere) const;
+    // Battery worth having before leaving the dock for an excursion of `excursionSteps` (0 means as long as possible)
+    std::size_t requiredCharge(std::size_t excursionSteps = 0) const;
+    bool chargingComplete(std::size_t batteryState, std::size_t excursionSteps = 0) const;
+    // Staying in the dock until the end costs steps; leaving is only useful if there is time to go out, clean and come back
+    bool worthLeavingDock() const;
+    // Number of Stay steps still needed to reach requiredCharge(excursionSteps)
+    std::size_t chargeStepsNeeded(std::size_t batteryState, std::size_t excursionSteps = 0) const;
+
+    // What the planner learned during a run (the capacity and the steps taken), for algorithm snapshots;
+    // the settings are not included
+    void saveState(std::ostream& out) const;
+    bool restoreState(std::istream& in);
+
+private:
+    std::size_t maxSteps = 0;
+    std::size_t returnMargin = 0;
+    double chargeFraction = 1.0;
+    std::size_t batteryCapacity = 0;
+    std::size_t stepsStarted = 0;
+};
+
+#endif // CHARGING_PLANNER_H
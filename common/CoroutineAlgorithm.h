@@ -0,0 +1,94 @@
+#ifndef COROUTINE_ALGORITHM_H_
+#define COROUTINE_ALGORITHM_H_
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+#include "AbstractAlgorithm.h"
+
+// Return type of CoroutineAlgorithm::steps(). The coroutine starts suspended and runs up to its next
+// co_yield each time next() is called; when the body returns, every further step is Step::Finish.
+class StepGenerator {
+public:
+    struct promise_type {
+        Step current = Step::Finish;
+        std::exception_ptr exception;
+
+        StepGenerator get_return_object() { return StepGenerator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(Step step) noexcept {
+            current = step;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { exception = std::current_exception(); }
+    };
+
+    StepGenerator() = default;
+    StepGenerator(StepGenerator&& other) noexcept : coroutine(std::exchange(other.coroutine, {})) {}
+    StepGenerator& operator=(StepGenerator&& other) noexcept {
+        if (this != &other) {
+            reset();
+            coroutine = std::exchange(other.coroutine, {});
+        }
+        return *this;
+    }
+    StepGenerator(const StepGenerator&) = delete;
+    StepGenerator& operator=(const StepGenerator&) = delete;
+    ~StepGenerator() { reset(); }
+
+    bool valid() const { return static_cast<bool>(coroutine); }
+
+    Step next() {
+        if (!coroutine || coroutine.done()) {
+            return Step::Finish;
+        }
+        coroutine.resume();
+        if (coroutine.promise().exception) {
+            std::rethrow_exception(std::exchange(coroutine.promise().exception, nullptr));
+        }
+        return coroutine.done() ? Step::Finish : coroutine.promise().current;
+    }
+
+private:
+    explicit StepGenerator(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {}
+
+    void reset() {
+        if (coroutine) {
+            coroutine.destroy();
+            coroutine = {};
+        }
+    }
+
+    std::coroutine_handle<promise_type> coroutine;
+};
+
+// Optional alternative to implementing nextStep() as a state machine: the algorithm is written as one
+// coroutine that reads the sensors and co_yields a Step whenever it wants the robot to act, e.g.
+//
+//     StepGenerator steps() override {
+//         while (batteryMeter->getBatteryState() > 1) co_yield Step::Stay;
+//         co_yield Step::Finish;
+//     }
+//
+// The coroutine is created on the first nextStep(), after the sensors and max steps are set, and the
+// simulator resumes it once per step. Its frame lives as long as the algorithm instance.
+class CoroutineAlgorithm : public AbstractAlgorithm {
+public:
+	Step nextStep() override {
+		if (!generator.valid()) {
+			generator = steps();
+		}
+		return generator.next();
+	}
+
+protected:
+	virtual StepGenerator steps() = 0;
+
+private:
+	StepGenerator generator;
+};
+
+#endif  // COROUTINE_ALGORITHM_H_
@@ -0,0 +1,17 @@
+#ifndef PARAMETERIZED_ALGORITHM_H_
+#define PARAMETERIZED_ALGORITHM_H_
+
+#include <string>
+
+#include "AbstractAlgorithm.h"
+
+// Optional extension of AbstractAlgorithm for algorithms with tunable constants.
+// The simulator detects it with dynamic_cast and, in a parameter sweep, calls setParameter
+// for every parameter of the configuration before the sensors are set.
+class ParameterizedAlgorithm : public AbstractAlgorithm {
+public:
+	// Returns false if the algorithm has no parameter with this name
+	virtual bool setParameter(const std::string& name, double value) = 0;
+};
+
+#endif  // PARAMETERIZED_ALGORITHM_H_
@@ -0,0 +1,19 @@
+#ifndef SNAPSHOT_ALGORITHM_H_
+#define SNAPSHOT_ALGORITHM_H_
+
+#include <string>
+
+// Optional interface for algorithms whose run can be snapshotted and forked (-fork_at).
+// The simulator detects it with dynamic_cast next to AbstractAlgorithm. The state is whatever the algorithm
+// learned during the run so far, as an opaque blob; parameters and sensors are not part of it. The shipped
+// algorithms write it with StateWriter and read it with StateReader (AlgorithmState.h).
+class SnapshotAlgorithm {
+public:
+	virtual ~SnapshotAlgorithm() {}
+	virtual std::string saveState() const = 0;
+	// Called on a fresh instance after its parameters, max steps and sensors are set. Returns false if the
+	// blob is not one this algorithm wrote.
+	virtual bool restoreState(const std::string& state) = 0;
+};
+
+#endif  // SNAPSHOT_ALGORITHM_H_
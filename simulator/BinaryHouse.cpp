@@ -0,0 +1,151 @@
+#include "BinaryHouse.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+constexpr std::uint32_t kBinaryHouseMagic = 0x42484356;  // "VCHB"
+constexpr std::uint32_t kBinaryHouseVersion = 1;
+constexpr std::uint8_t kDockNibble = 0xD;
+constexpr std::uint8_t kOtherNibble = 0xF;
+
+#pragma pack(push, 1)
+struct BinaryHouseHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t rows;
+    std::uint32_t cols;
+    std::uint64_t maxSteps;
+    std::uint64_t maxBattery;
+    std::int32_t dockRow;
+    std::int32_t dockCol;
+    std::int64_t totalDirt;
+    std::uint32_t descriptionLength;
+    std::uint32_t reserved;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(BinaryHouseHeader) == 56, "binary house header layout changed");
+
+std::size_t wallPlaneSize(std::size_t cells) {
+    return (cells + 7) / 8;
+}
+
+std::size_t cellPlaneSize(std::size_t cells) {
+    return (cells + 1) / 2;
+}
+
+}  // namespace
+
+bool isBinaryHouse(const char* data, std::size_t size) {
+    std::uint32_t magic = 0;
+    if (size < sizeof(magic)) {
+        return false;
+    }
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == kBinaryHouseMagic;
+}
+
+std::string encodeBinaryHouse(const StoredHouse& house) {
+    std::size_t cells = house.rows * house.cols;
+    BinaryHouseHeader header{kBinaryHouseMagic, kBinaryHouseVersion,
+                             static_cast<std::uint32_t>(house.rows), static_cast<std::uint32_t>(house.cols),
+                             house.maxSteps, house.maxBattery, house.dockRow, house.dockCol, house.initialDirt,
+                             static_cast<std::uint32_t>(house.description.size()), 0};
+
+    std::string encoded(sizeof(header) + house.description.size() + wallPlaneSize(cells) + cellPlaneSize(cells), '\0');
+    char* out = encoded.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, house.description.data(), house.description.size());
+    out += house.description.size();
+
+    auto* walls = reinterpret_cast<std::uint8_t*>(out);
+    auto* nibbles = walls + wallPlaneSize(cells);
+    for (std::size_t i = 0; i < cells; ++i) {
+        char cell = house.cells[i];
+        std::uint8_t nibble = kOtherNibble;
+        if (cell == 'W') {
+            walls[i / 8] |= static_cast<std::uint8_t>(1u << (i % 8));
+        } else if (cell >= '0' && cell <= '9') {
+            nibble = static_cast<std::uint8_t>(cell - '0');
+        } else if (cell == 'D') {
+            nibble = kDockNibble;
+        }
+        nibbles[i / 2] |= static_cast<std::uint8_t>(nibble << (4 * (i % 2)));
+    }
+    return encoded;
+}
+
+bool decodeBinaryHouseHeader(const char* data, std::size_t size, StoredHouse& house) {
+    BinaryHouseHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kBinaryHouseMagic || header.version != kBinaryHouseVersion) {
+        return false;
+    }
+    house.maxSteps = header.maxSteps;
+    house.maxBattery = header.maxBattery;
+    house.rows = header.rows;
+    house.cols = header.cols;
+    house.dockRow = header.dockRow;
+    house.dockCol = header.dockCol;
+    house.initialDirt = static_cast<int>(header.totalDirt);
+    return true;
+}
+
+bool decodeBinaryHouse(const char* data, std::size_t size, StoredHouse& house, std::string& error) {
+    BinaryHouseHeader header;
+    if (size < sizeof(header)) {
+        error = "truncated header";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kBinaryHouseMagic) {
+        error = "not a binary house file";
+        return false;
+    }
+    if (header.version != kBinaryHouseVersion) {
+        error = "unsupported binary house version " + std::to_string(header.version);
+        return false;
+    }
+
+    std::size_t cells = static_cast<std::size_t>(header.rows) * header.cols;
+    std::size_t expected = sizeof(header) + header.descriptionLength + wallPlaneSize(cells) + cellPlaneSize(cells);
+    if (size < expected) {
+        error = "truncated house data";
+        return false;
+    }
+    if (header.dockRow < 0 || header.dockCol < 0 ||
+        static_cast<std::uint32_t>(header.dockRow) >= header.rows || static_cast<std::uint32_t>(header.dockCol) >= header.cols) {
+        error = "dock outside the house";
+        return false;
+    }
+
+    const char* in = data + sizeof(header);
+    house.description.assign(in, header.descriptionLength);
+    in += header.descriptionLength;
+    house.maxSteps = header.maxSteps;
+    house.maxBattery = header.maxBattery;
+    house.rows = header.rows;
+    house.cols = header.cols;
+    house.dockRow = header.dockRow;
+    house.dockCol = header.dockCol;
+    house.initialDirt = static_cast<int>(header.totalDirt);
+
+    const auto* walls = reinterpret_cast<const std::uint8_t*>(in);
+    const auto* nibbles = walls + wallPlaneSize(cells);
+    house.cells.resize(cells);
+    for (std::size_t i = 0; i < cells; ++i) {
+        if (walls[i / 8] & (1u << (i % 8))) {
+            house.cells[i] = 'W';
+            continue;
+        }
+        std::uint8_t nibble = (nibbles[i / 2] >> (4 * (i % 2))) & 0xF;
+        house.cells[i] = nibble <= 9 ? static_cast<char>('0' + nibble) : nibble == kDockNibble ? 'D' : ' ';
+    }
+    return true;
+}
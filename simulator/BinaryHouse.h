@@ -0,0 +1,27 @@
+#ifndef BINARY_HOUSE_H
+#define BINARY_HOUSE_H
+
+#include <cstddef>
+#include <string>
+
+#include "SharedHouseStore.h"
+
+// Binary house files (.houseb), written by `simulator convert` and accepted anywhere a .house file is.
+// All integers are little-endian:
+//   header       magic "VCHB", version, rows, cols (u32); maxSteps, maxBattery (u64);
+//                dockRow, dockCol (i32); totalDirt (i64); descriptionLength (u32), reserved (u32)
+//   description  descriptionLength bytes
+//   wall plane   rows * cols bits, row-major, least significant bit first
+//   cell plane   rows * cols nibbles, row-major, low nibble first: 0-9 dirt, 0xD a 'D' cell,
+//                0xF any other cell that is not a wall (read back as ' ')
+// The dock position and the total dirt are stored, so loading does not scan the cells at all.
+
+constexpr const char* kBinaryHouseExtension = ".houseb";
+
+bool isBinaryHouse(const char* data, std::size_t size);
+std::string encodeBinaryHouse(const StoredHouse& house);
+bool decodeBinaryHouse(const char* data, std::size_t size, StoredHouse& house, std::string& error);
+// Fills everything but the description and the cells from the header alone
+bool decodeBinaryHouseHeader(const char* data, std::size_t size, StoredHouse& house);
+
+#endif // BINARY_HOUSE_H
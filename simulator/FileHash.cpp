@@ -0,0 +1,35 @@
+#include "FileHash.h"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+std::uint64_t hashBytes(const void* data, std::size_t length, std::uint64_t hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+bool hashFile(const std::string& path, std::uint64_t& hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<char> buffer(1 << 16);
+    hash = kFnvOffsetBasis;
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = hashBytes(buffer.data(), static_cast<std::size_t>(file.gcount()), hash);
+    }
+    return true;
+}
+
+std::string hashToHex(std::uint64_t hash) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
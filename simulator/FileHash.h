@@ -0,0 +1,16 @@
+#ifndef FILE_HASH_H
+#define FILE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit FNV-1a, used wherever the simulator needs a stable content hash (run manifests, caches)
+constexpr std::uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+
+std::uint64_t hashBytes(const void* data, std::size_t length, std::uint64_t hash = kFnvOffsetBasis);
+// Returns false if the file cannot be read
+bool hashFile(const std::string& path, std::uint64_t& hash);
+std::string hashToHex(std::uint64_t hash);
+
+#endif // FILE_HASH_H
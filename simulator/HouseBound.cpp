@@ -0,0 +1,146 @@
+#include "HouseBound.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+constexpr std::int32_t kUnreached = -1;
+
+int dirtAt(char cell) {
+    return cell >= '1' && cell <= '9' ? cell - '0' : 0;
+}
+
+// Breadth-first search over the open cells from every source at once. Each reached cell gets its distance to
+// the nearest source and the index of that source.
+void distanceField(const StoredHouse& house, const std::vector<std::uint32_t>& sources, std::vector<std::int32_t>& distance,
+                   std::vector<std::uint32_t>& nearest) {
+    const std::size_t cellCount = house.rows * house.cols;
+    distance.assign(cellCount, kUnreached);
+    nearest.assign(cellCount, 0);
+    std::vector<std::uint32_t> queue;
+    queue.reserve(cellCount);
+    for (std::uint32_t source = 0; source < sources.size(); ++source) {
+        distance[sources[source]] = 0;
+        nearest[sources[source]] = source;
+        queue.push_back(sources[source]);
+    }
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        std::uint32_t cell = queue[head];
+        std::size_t x = cell / house.cols;
+        std::size_t y = cell % house.cols;
+        auto visit = [&](std::uint32_t next) {
+            if (distance[next] == kUnreached && house.cells[next] != 'W') {
+                distance[next] = distance[cell] + 1;
+                nearest[next] = nearest[cell];
+                queue.push_back(next);
+            }
+        };
+        if (y > 0) visit(cell - 1);
+        if (y + 1 < house.cols) visit(cell + 1);
+        if (x > 0) visit(cell - static_cast<std::uint32_t>(house.cols));
+        if (x + 1 < house.rows) visit(cell + static_cast<std::uint32_t>(house.cols));
+    }
+}
+
+std::uint32_t findRoot(std::vector<std::uint32_t>& parent, std::uint32_t node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];
+        node = parent[node];
+    }
+    return node;
+}
+
+}  // namespace
+
+HouseBound computeHouseBound(const StoredHouse& house) {
+    HouseBound bound;
+    bound.initialDirt = house.initialDirt;
+    const std::size_t cellCount = house.rows * house.cols;
+    if (cellCount == 0 || house.cells.size() != cellCount) {
+        bound.scoreBound = 300LL * house.initialDirt;
+        return bound;
+    }
+    const auto dock = static_cast<std::uint32_t>(house.dockRow * house.cols + house.dockCol);
+    const long long battery = static_cast<long long>(house.maxBattery);
+
+    std::vector<std::int32_t> fromDock;
+    std::vector<std::uint32_t> unused;
+    distanceField(house, {dock}, fromDock, unused);
+
+    // The dock and every dirty cell a trip can reach, clean at least once and come back from
+    std::vector<std::uint32_t> terminals{dock};
+    long long farthest = 0;
+    long long batteryMoves = 0;
+    for (std::uint32_t cell = 0; cell < cellCount; ++cell) {
+        int dirt = dirtAt(house.cells[cell]);
+        if (dirt == 0 || fromDock[cell] == kUnreached) {
+            continue;
+        }
+        bound.reachableDirt += dirt;
+        long long roundTrip = 2LL * fromDock[cell];
+        if (roundTrip + 1 > battery) {
+            continue;
+        }
+        bound.cleanableDirt += dirt;
+        terminals.push_back(cell);
+        farthest = std::max(farthest, roundTrip);
+        // Each trip cleans at most what is left of the battery after the round trip
+        long long trips = (dirt + (battery - roundTrip) - 1) / (battery - roundTrip);
+        batteryMoves = std::max(batteryMoves, trips * roundTrip);
+    }
+
+    if (terminals.size() > 1) {
+        // Minimum spanning tree of the terminals under grid distances: the edges between neighbouring cells of
+        // different nearest terminals are the only candidates (Mehlhorn, 1988)
+        std::vector<std::int32_t> distance;
+        std::vector<std::uint32_t> nearest;
+        distanceField(house, terminals, distance, nearest);
+        std::vector<std::tuple<std::int32_t, std::uint32_t, std::uint32_t>> bridges;
+        for (std::uint32_t cell = 0; cell < cellCount; ++cell) {
+            if (distance[cell] == kUnreached) {
+                continue;
+            }
+            auto bridge = [&](std::uint32_t next) {
+                if (distance[next] != kUnreached && nearest[next] != nearest[cell]) {
+                    bridges.emplace_back(distance[cell] + 1 + distance[next], nearest[cell], nearest[next]);
+                }
+            };
+            if ((cell % house.cols) + 1 < house.cols) bridge(cell + 1);
+            if (cell + house.cols < cellCount) bridge(cell + static_cast<std::uint32_t>(house.cols));
+        }
+        std::sort(bridges.begin(), bridges.end());
+        std::vector<std::uint32_t> parent(terminals.size());
+        std::iota(parent.begin(), parent.end(), 0);
+        long long treeLength = 0;
+        for (const auto& [length, a, b] : bridges) {
+            std::uint32_t rootA = findRoot(parent, a);
+            std::uint32_t rootB = findRoot(parent, b);
+            if (rootA != rootB) {
+                parent[rootA] = rootB;
+                treeLength += length;
+            }
+        }
+        // A closed walk through all terminals is a spanning tree plus at least one more move
+        bound.moves = std::max({treeLength + 1, farthest, batteryMoves});
+    }
+
+    long long work = bound.moves + bound.cleanableDirt;
+    long long chargePerStep = std::max<long long>(1, battery / 20);
+    bound.chargeSteps = work > battery ? (work - battery + chargePerStep - 1) / chargePerStep : 0;
+    bound.minSteps = work + bound.chargeSteps;
+
+    long long leftAnyway = 300LL * (house.initialDirt - bound.cleanableDirt);
+    long long maxSteps = static_cast<long long>(house.maxSteps);
+    if (bound.minSteps <= maxSteps) {
+        bound.scoreBound = bound.minSteps + leftAnyway;
+    } else {
+        // Not everything can be cleaned in time; every unit cleaned still takes a step
+        long long cleaned = std::min<long long>(maxSteps, bound.cleanableDirt);
+        bound.scoreBound = cleaned + 300LL * (bound.cleanableDirt - cleaned) + leftAnyway;
+    }
+    return bound;
+}
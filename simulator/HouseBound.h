@@ -0,0 +1,30 @@
+#ifndef HOUSE_BOUND_H
+#define HOUSE_BOUND_H
+
+#include <cstddef>
+
+#include "SharedHouseStore.h"
+
+// The best any algorithm can do on a house, for judging how far a score is from it. The bound assumes the
+// rules the algorithms play by: the robot never empties its battery away from the dock, so every cleaning
+// trip starts and ends in the dock, and it charges maxBattery / 20 (at least 1) per step spent in the dock.
+//
+// Cleaning needs one step per unit of dirt plus the moves of a closed walk from the dock through every dirty
+// cell. The moves are bounded below by the largest of: the minimum spanning tree of the dirty cells and the
+// dock under grid distances, plus one; twice the distance to the farthest dirty cell; and, per dirty cell, the
+// round trips the battery forces to clean all of it. The tree is found with a multi-source BFS from all of
+// those cells at once (Mehlhorn's construction), so it costs one pass over the grid. Every unit of energy
+// beyond the first battery has to be charged, which adds the charging steps.
+struct HouseBound {
+    int initialDirt = 0;
+    int reachableDirt = 0;  // On cells connected to the dock
+    int cleanableDirt = 0;  // On cells within half a battery of the dock, which a trip can clean and return from
+    long long moves = 0;
+    long long chargeSteps = 0;
+    long long minSteps = 0; // Moves, cleaning steps and charging steps to clean all cleanable dirt and end in the dock
+    long long scoreBound = 0; // Lowest score the rules allow, on the simulator's scale
+};
+
+HouseBound computeHouseBound(const StoredHouse& house);
+
+#endif // HOUSE_BOUND_H
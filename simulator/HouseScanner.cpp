@@ -0,0 +1,118 @@
+#include "HouseScanner.h"
+
+#if defined(__x86_64__)
+#define HOUSE_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+RowScan scanHouseRowScalar(const char* row, std::size_t length) {
+    RowScan scan;
+    for (std::size_t j = 0; j < length; ++j) {
+        char cell = row[j];
+        if (cell == 'D') {
+            scan.dockColumn = static_cast<long>(j);
+        } else if (cell >= '1' && cell <= '9') {
+            scan.dirtSum += cell - '0';
+        }
+    }
+    return scan;
+}
+
+#ifdef HOUSE_SCANNER_X86
+
+namespace {
+
+// Adds the scan of the unvectorized tail starting at `offset`
+void scanTail(const char* row, std::size_t offset, std::size_t length, RowScan& scan) {
+    RowScan tail = scanHouseRowScalar(row + offset, length - offset);
+    scan.dirtSum += tail.dirtSum;
+    if (tail.dockColumn >= 0) {
+        scan.dockColumn = static_cast<long>(offset) + tail.dockColumn;
+    }
+}
+
+__attribute__((target("sse2")))
+RowScan scanSse2(const char* row, std::size_t length) {
+    const __m128i zeroChar = _mm_set1_epi8('0');
+    const __m128i oneChar = _mm_set1_epi8('1');
+    const __m128i eight = _mm_set1_epi8(8);
+    const __m128i dock = _mm_set1_epi8('D');
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums = _mm_setzero_si128();
+    RowScan scan;
+
+    std::size_t j = 0;
+    for (; j + 16 <= length; j += 16) {
+        __m128i cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j));
+        // '1'..'9' <=> (cell - '1') <= 8 as unsigned bytes
+        __m128i fromOne = _mm_sub_epi8(cells, oneChar);
+        __m128i isDirt = _mm_cmpeq_epi8(_mm_min_epu8(fromOne, eight), fromOne);
+        __m128i dirt = _mm_and_si128(isDirt, _mm_sub_epi8(cells, zeroChar));
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(dirt, zero));
+
+        unsigned docks = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(cells, dock)));
+        if (docks) {
+            scan.dockColumn = static_cast<long>(j) + 31 - __builtin_clz(docks);
+        }
+    }
+    scan.dirtSum = _mm_cvtsi128_si64(sums) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+    scanTail(row, j, length, scan);
+    return scan;
+}
+
+__attribute__((target("avx2")))
+RowScan scanAvx2(const char* row, std::size_t length) {
+    const __m256i zeroChar = _mm256_set1_epi8('0');
+    const __m256i oneChar = _mm256_set1_epi8('1');
+    const __m256i eight = _mm256_set1_epi8(8);
+    const __m256i dock = _mm256_set1_epi8('D');
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sums = _mm256_setzero_si256();
+    RowScan scan;
+
+    std::size_t j = 0;
+    for (; j + 32 <= length; j += 32) {
+        __m256i cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + j));
+        __m256i fromOne = _mm256_sub_epi8(cells, oneChar);
+        __m256i isDirt = _mm256_cmpeq_epi8(_mm256_min_epu8(fromOne, eight), fromOne);
+        __m256i dirt = _mm256_and_si256(isDirt, _mm256_sub_epi8(cells, zeroChar));
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(dirt, zero));
+
+        unsigned docks = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(cells, dock)));
+        if (docks) {
+            scan.dockColumn = static_cast<long>(j) + 31 - __builtin_clz(docks);
+        }
+    }
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    scan.dirtSum = _mm_cvtsi128_si64(half) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(half, half));
+    scanTail(row, j, length, scan);
+    return scan;
+}
+
+using RowScanner = RowScan (*)(const char*, std::size_t);
+
+RowScanner pickScanner() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return scanAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return scanSse2;
+    }
+    return scanHouseRowScalar;
+}
+
+}  // namespace
+
+RowScan scanHouseRow(const char* row, std::size_t length) {
+    static const RowScanner scanner = pickScanner();
+    return scanner(row, length);
+}
+
+#else
+
+RowScan scanHouseRow(const char* row, std::size_t length) {
+    return scanHouseRowScalar(row, length);
+}
+
+#endif
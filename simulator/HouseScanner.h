@@ -0,0 +1,19 @@
+#ifndef HOUSE_SCANNER_H
+#define HOUSE_SCANNER_H
+
+#include <cstddef>
+
+// What readHouseFile needs from one row of the house grid
+struct RowScan {
+    long dirtSum = 0;       // Sum of the digits '1'..'9'
+    long dockColumn = -1;   // Column of the last 'D' in the row, -1 if there is none
+};
+
+// Classifies the bytes of a row in bulk: AVX2 when the CPU has it, SSE2 on other x86-64 CPUs and a
+// scalar loop elsewhere. The implementation is picked once, on first use.
+RowScan scanHouseRow(const char* row, std::size_t length);
+
+// The portable version, also used for the tail of a row that does not fill a whole vector
+RowScan scanHouseRowScalar(const char* row, std::size_t length);
+
+#endif // HOUSE_SCANNER_H
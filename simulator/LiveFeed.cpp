@@ -0,0 +1,255 @@
+#include "LiveFeed.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kPollIntervalMs = 50;
+constexpr std::size_t kMaxQueuedLines = 1 << 16;
+
+}  // namespace
+
+LiveFeed::~LiveFeed() {
+    stop();
+}
+
+bool LiveFeed::start(const std::string& socketPath, double updatesPerSecond, const std::string& filter) {
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socketPath << std::endl;
+        return false;
+    }
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "Cannot create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listenFd, 16) != 0) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    this->socketPath = socketPath;
+    this->filter = filter;
+    minInterval = updatesPerSecond > 0
+        ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / updatesPerSecond))
+        : std::chrono::steady_clock::duration::zero();
+    stopping = false;
+    sender = std::thread(&LiveFeed::sendLoop, this);
+    return true;
+}
+
+void LiveFeed::stop() {
+    if (listenFd < 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(feedMutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    sender.join();
+    for (int viewer : viewers) {
+        ::close(viewer);
+    }
+    viewers.clear();
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+    listenFd = -1;
+}
+
+bool LiveFeed::waitForViewer(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(feedMutex);
+    return changed.wait_for(lock, timeout, [this] { return viewerCount > 0 || stopping; }) && viewerCount > 0;
+}
+
+std::uint64_t LiveFeed::beginRun(const std::string& houseName, const std::string& algorithmName, const std::string& parameters,
+                                 const std::vector<std::vector<char>>& house, int dockRow, int dockCol,
+                                 std::size_t maxSteps, std::size_t maxBattery) {
+    if (!running() || (!filter.empty() && houseName.find(filter) == std::string::npos && algorithmName.find(filter) == std::string::npos)) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> guard(feedMutex);
+    std::uint64_t runId = nextRunId++;
+    FollowedRun& run = runs[runId];
+    run.header = "RUN " + std::to_string(runId) + " " + std::to_string(house.size()) + " " +
+                 std::to_string(house.empty() ? 0 : house[0].size()) + " " + std::to_string(dockRow) + " " +
+                 std::to_string(dockCol) + " " + std::to_string(maxSteps) + " " + std::to_string(maxBattery) + " " +
+                 houseName + " " + algorithmName + (parameters.empty() ? "" : " " + parameters);
+    run.rows.reserve(house.size());
+    for (const auto& row : house) {
+        run.rows.emplace_back(row.begin(), row.end());
+    }
+    run.row = dockRow;
+    run.col = dockCol;
+    run.battery = maxBattery;
+    run.status = "WORKING";
+    run.lastSent = std::chrono::steady_clock::now();
+
+    publish(run.header);
+    for (std::size_t r = 0; r < run.rows.size(); ++r) {
+        publish("ROW " + std::to_string(runId) + " " + std::to_string(r) + " " + run.rows[r]);
+    }
+    return runId;
+}
+
+std::string LiveFeed::stepLine(std::uint64_t runId, FollowedRun& run) {
+    std::string line = "STEP " + std::to_string(runId) + " " + std::to_string(run.steps) + " " + std::to_string(run.row) + " " +
+                       std::to_string(run.col) + " " + std::to_string(run.battery) + " " + run.status;
+    for (const auto& [cell, dirt] : run.pendingCells) {
+        line += " " + std::to_string(cell.first) + "," + std::to_string(cell.second) + "," + std::to_string(dirt);
+    }
+    run.pendingCells.clear();
+    return line;
+}
+
+void LiveFeed::step(std::uint64_t runId, int steps, int row, int col, std::size_t battery, const std::string& status,
+                    bool cleaned, int dirt) {
+    std::lock_guard<std::mutex> guard(feedMutex);
+    auto found = runs.find(runId);
+    if (found == runs.end()) {
+        return;
+    }
+    FollowedRun& run = found->second;
+    run.steps = steps;
+    run.row = row;
+    run.col = col;
+    run.battery = battery;
+    run.status = status;
+    if (cleaned) {
+        run.pendingCells[{row, col}] = dirt;
+        run.rows[row][col] = static_cast<char>('0' + dirt);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - run.lastSent >= minInterval) {
+        run.lastSent = now;
+        publish(stepLine(runId, run));
+    }
+}
+
+void LiveFeed::endRun(std::uint64_t runId, const std::string& status, int steps, int dirtLeft, int score) {
+    std::lock_guard<std::mutex> guard(feedMutex);
+    auto found = runs.find(runId);
+    if (found == runs.end()) {
+        return;
+    }
+    found->second.status = status;
+    publish(stepLine(runId, found->second));  // The final state is never rate limited away
+    publish("END " + std::to_string(runId) + " " + status + " " + std::to_string(steps) + " " +
+            std::to_string(dirtLeft) + " " + std::to_string(score));
+    runs.erase(found);
+}
+
+// Called with feedMutex held
+void LiveFeed::publish(std::string line) {
+    if (viewerCount == 0) {
+        return;  // Late viewers get the current state when they connect
+    }
+    if (outgoing.size() >= kMaxQueuedLines) {
+        overflowed = true;
+        return;
+    }
+    outgoing.push_back(std::move(line));
+    changed.notify_all();
+}
+
+void LiveFeed::sendToViewers(const std::vector<std::string>& lines) {
+    std::string data;
+    for (const auto& line : lines) {
+        data += line;
+        data += '\n';
+    }
+    for (auto it = viewers.begin(); it != viewers.end();) {
+        ssize_t sent = ::send(*it, data.data(), data.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent != static_cast<ssize_t>(data.size())) {
+            // Gone, or too slow: a partial line would corrupt its stream, so let it reconnect instead
+            ::close(*it);
+            it = viewers.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
+void LiveFeed::sendLoop() {
+    while (true) {
+        std::vector<std::string> lines;
+        bool resync = false;
+        {
+            std::unique_lock<std::mutex> lock(feedMutex);
+            changed.wait_for(lock, std::chrono::milliseconds(kPollIntervalMs), [this] { return stopping || !outgoing.empty(); });
+            lines.assign(std::make_move_iterator(outgoing.begin()), std::make_move_iterator(outgoing.end()));
+            outgoing.clear();
+            resync = std::exchange(overflowed, false);
+        }
+        if (resync) {
+            // Lines were dropped; the viewers' state is no longer exact
+            for (int viewer : viewers) {
+                ::close(viewer);
+            }
+            viewers.clear();
+        } else if (!lines.empty()) {
+            sendToViewers(lines);
+        }
+
+        bool accepted = false;
+        pollfd listenPoll{listenFd, POLLIN, 0};
+        while (::poll(&listenPoll, 1, 0) > 0) {
+            int viewer = ::accept(listenFd, nullptr, nullptr);
+            if (viewer < 0) {
+                break;
+            }
+            // Current state of every followed run, so the viewer can start anywhere
+            std::vector<std::string> snapshot;
+            {
+                // Counted from here on, so every line published after the snapshot is queued for it
+                std::lock_guard<std::mutex> guard(feedMutex);
+                viewerCount++;
+                for (auto& [runId, run] : runs) {
+                    snapshot.push_back(run.header);
+                    for (std::size_t r = 0; r < run.rows.size(); ++r) {
+                        snapshot.push_back("ROW " + std::to_string(runId) + " " + std::to_string(r) + " " + run.rows[r]);
+                    }
+                    auto pending = run.pendingCells;
+                    snapshot.push_back(stepLine(runId, run));
+                    run.pendingCells = std::move(pending);  // Still owed to the viewers already connected
+                }
+            }
+            std::vector<int> others;
+            others.swap(viewers);
+            viewers.push_back(viewer);
+            sendToViewers(snapshot);
+            viewers.insert(viewers.end(), others.begin(), others.end());
+            accepted = true;
+        }
+
+        std::lock_guard<std::mutex> guard(feedMutex);
+        if (accepted || viewerCount != viewers.size()) {
+            viewerCount = viewers.size();
+            changed.notify_all();
+        }
+        if (viewerCount == 0) {
+            outgoing.clear();
+        }
+        if (stopping && outgoing.empty()) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef LIVE_FEED_H
+#define LIVE_FEED_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Live view of running simulations for viewers on a Unix domain socket (visualize.py --live <socket>).
+// The simulator publishes, one text line per event:
+//   RUN <id> <rows> <cols> <dockRow> <dockCol> <maxSteps> <maxBattery> <house> <algorithm> [parameters]
+//   ROW <id> <row> <cells>                 the house as it is now, one line per row
+//   STEP <id> <steps> <row> <col> <battery> <status> [<row>,<col>,<dirt>...]
+//   END <id> <status> <steps> <dirtLeft> <score>
+// The status of END is that of the output files, FORKED for a -fork_at trunk that stops at its snapshot, or
+// FAILED for a run whose algorithm threw; every RUN gets its END.
+// STEP lines are rate limited per run. The cells cleaned in between are carried by the next STEP, and
+// every value is absolute, so a viewer that applies each line in order always has the exact house, and a
+// line seen twice does no harm. Viewers that connect late first get RUN and ROW lines for the runs in
+// progress; viewers that cannot keep up are disconnected rather than slowing the simulation down.
+class LiveFeed {
+public:
+    LiveFeed() = default;
+    ~LiveFeed();
+    LiveFeed(const LiveFeed&) = delete;
+    LiveFeed& operator=(const LiveFeed&) = delete;
+
+    // Follows the runs whose house or algorithm name contains `filter` (all runs if empty)
+    bool start(const std::string& socketPath, double updatesPerSecond, const std::string& filter);
+    void stop();
+    bool running() const { return listenFd >= 0; }
+    // Blocks until a viewer is connected or `timeout` passes
+    bool waitForViewer(std::chrono::milliseconds timeout);
+
+    // Returns the id of the run in the feed, 0 if it is not followed
+    std::uint64_t beginRun(const std::string& houseName, const std::string& algorithmName, const std::string& parameters,
+                           const std::vector<std::vector<char>>& house, int dockRow, int dockCol,
+                           std::size_t maxSteps, std::size_t maxBattery);
+    // One simulation step; `cleaned` says whether the dirt of the current cell changed to `dirt`
+    void step(std::uint64_t runId, int steps, int row, int col, std::size_t battery, const std::string& status,
+              bool cleaned, int dirt);
+    void endRun(std::uint64_t runId, const std::string& status, int steps, int dirtLeft, int score);
+
+private:
+    struct FollowedRun {
+        std::string header;
+        std::vector<std::string> rows;
+        std::map<std::pair<int, int>, int> pendingCells;
+        std::string lastStep;
+        int steps = 0;
+        int row = 0;
+        int col = 0;
+        std::size_t battery = 0;
+        std::string status;
+        std::chrono::steady_clock::time_point lastSent;
+    };
+
+    std::string stepLine(std::uint64_t runId, FollowedRun& run);
+    void publish(std::string line);
+    void sendLoop();
+    void sendToViewers(const std::vector<std::string>& lines);
+
+    std::string socketPath;
+    std::string filter;
+    std::chrono::steady_clock::duration minInterval{};
+    int listenFd = -1;
+
+    std::mutex feedMutex;
+    std::condition_variable changed;
+    std::map<std::uint64_t, FollowedRun> runs;
+    std::uint64_t nextRunId = 1;
+    std::deque<std::string> outgoing;
+    bool overflowed = false;
+    bool stopping = false;
+    std::vector<int> viewers;  // Only touched by the sender thread, apart from the count below
+    std::size_t viewerCount = 0;
+    std::thread sender;
+};
+
+#endif // LIVE_FEED_H
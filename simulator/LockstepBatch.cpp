@@ -0,0 +1,128 @@
+#include "LockstepBatch.h"
+
+#include <algorithm>
+
+LockstepBatch::LockstepBatch(const TiledHouse& house, std::tuple<int, int> dockingStation,
+                             std::size_t maxSteps, std::size_t maxBattery, int initialDirt, std::size_t lanes)
+    : laneCount(lanes), maxSteps(maxSteps), maxBattery(maxBattery) {
+    std::size_t rows = house.rows();
+    std::size_t cols = house.cols();
+    stride = cols + 2;
+    cellCount = (rows + 2) * stride;
+    dockCell = static_cast<std::uint32_t>((std::get<0>(dockingStation) + 1) * stride + std::get<1>(dockingStation) + 1);
+    chargeAmount = static_cast<std::uint32_t>(std::max<std::size_t>(1, maxBattery / 20));
+
+    wallMask.assign(cellCount, 1);
+    std::vector<std::uint8_t> initialPlane(cellCount, 0);
+    for (std::size_t x = 0; x < rows; ++x) {
+        for (std::size_t y = 0; y < cols; ++y) {
+            char cell = house.at(x, y);
+            std::size_t index = (x + 1) * stride + y + 1;
+            wallMask[index] = cell == 'W';
+            initialPlane[index] = (cell >= '1' && cell <= '9') ? cell - '0' : 0;
+        }
+    }
+    dirt.resize(cellCount * lanes);
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        std::copy(initialPlane.begin(), initialPlane.end(), dirt.begin() + lane * cellCount);
+    }
+
+    position.assign(lanes, dockCell);
+    battery.assign(lanes, static_cast<std::uint32_t>(maxBattery));
+    numSteps.assign(lanes, 0);
+    dirtLeft.assign(lanes, initialDirt);
+    inDock.assign(lanes, 1);
+    // Same special case as the single-run path: a battery of 1 cannot leave the dock
+    status.assign(lanes, maxBattery == 1 ? RunStatus::Finished : RunStatus::Working);
+    history.assign(lanes, std::vector<std::uint32_t>{dockCell});
+    moveOffset.assign(lanes, 0);
+    moving.assign(lanes, 0);
+
+    wallsSensors.reserve(lanes);
+    dirtSensors.reserve(lanes);
+    batteryMeters.reserve(lanes);
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+        wallsSensors.emplace_back(false, false, false, false);
+        dirtSensors.emplace_back(0);
+        batteryMeters.emplace_back(maxBattery);
+        updateSensors(lane);
+    }
+
+    // The single-run path seeds the dirt sensor with the raw dock byte minus '0'; keep that so results match
+    int dockByte = house.at(std::get<0>(dockingStation), std::get<1>(dockingStation)) - '0';
+    for (auto& sensor : dirtSensors) {
+        sensor.setDirtLevel(dockByte);
+    }
+}
+
+bool LockstepBatch::anyActive() const {
+    for (std::size_t lane = 0; lane < laneCount; ++lane) {
+        if (active(lane)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void LockstepBatch::step(const std::vector<Step>& steps) {
+    const std::int32_t row = static_cast<std::int32_t>(stride);
+    // Indexed by Step: North is y-1, East x+1, South y+1, West x-1
+    const std::int32_t offsets[] = {-1, row, 1, -row, 0, 0};
+
+    // Classify all lanes first, then apply the moves; both loops are branch-light over plain arrays
+    for (std::size_t lane = 0; lane < laneCount; ++lane) {
+        bool live = active(lane);
+        Step next = steps[lane];
+        if (live && next == Step::Finish) {
+            status[lane] = RunStatus::Finished;
+            live = false;
+        }
+        moving[lane] = live;
+        moveOffset[lane] = offsets[static_cast<int>(next)];
+    }
+
+    for (std::size_t lane = 0; lane < laneCount; ++lane) {
+        if (!moving[lane]) {
+            continue;
+        }
+        std::uint32_t target = position[lane] + moveOffset[lane];
+        if (moveOffset[lane] != 0 && wallMask[target]) {
+            status[lane] = RunStatus::Dead;
+            continue;
+        }
+        position[lane] = target;
+        history[lane].push_back(target);
+        bool stay = moveOffset[lane] == 0;
+        bool docked = target == dockCell;
+        inDock[lane] = docked;
+
+        std::uint8_t& cellDirt = dirt[lane * cellCount + target];
+        bool cleans = stay && cellDirt > 0;
+        cellDirt -= cleans;
+        dirtLeft[lane] -= cleans;
+
+        if (docked && stay) {
+            battery[lane] = static_cast<std::uint32_t>(std::min<std::size_t>(battery[lane] + chargeAmount, maxBattery));
+        } else {
+            battery[lane] -= battery[lane] > 0;
+        }
+        numSteps[lane]++;
+        updateSensors(lane);
+    }
+}
+
+void LockstepBatch::updateSensors(std::size_t lane) {
+    std::uint32_t cell = position[lane];
+    wallsSensors[lane].setWalls(wallMask[cell - 1], wallMask[cell + stride], wallMask[cell + 1], wallMask[cell - stride]);
+    dirtSensors[lane].setDirtLevel(dirt[lane * cellCount + cell]);
+    batteryMeters[lane].setBatteryState(battery[lane]);
+}
+
+std::vector<std::tuple<int, int>> LockstepBatch::laneHistory(std::size_t lane) const {
+    std::vector<std::tuple<int, int>> steps;
+    steps.reserve(history[lane].size());
+    for (std::uint32_t cell : history[lane]) {
+        steps.emplace_back(static_cast<int>(cell / stride) - 1, static_cast<int>(cell % stride) - 1);
+    }
+    return steps;
+}
@@ -0,0 +1,78 @@
+#ifndef LOCKSTEP_BATCH_H
+#define LOCKSTEP_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "RunRecord.h"
+#include "TiledHouse.h"
+#include "../common/enums.h"
+#include "../common/ConcreteWallSensor.h"
+#include "../common/ConcreteDirtSensor.h"
+#include "../common/ConcreteBatteryMeter.h"
+
+// Advances N independent simulations ("lanes") of the same house in lockstep, one step per lane per call.
+// The per-lane state is kept as structure-of-arrays, the wall mask is built once and shared by all lanes,
+// and only the dirt, which the lanes clean differently, is kept per lane. The grid has a one-cell wall
+// border so a move is a table lookup with no bounds checks. The rules are exactly those of
+// MySimulator::advanceRun; only the per-step logging is left out.
+class LockstepBatch {
+public:
+    LockstepBatch(const TiledHouse& house, std::tuple<int, int> dockingStation,
+                  std::size_t maxSteps, std::size_t maxBattery, int initialDirt, std::size_t lanes);
+    LockstepBatch(const LockstepBatch&) = delete;
+    LockstepBatch& operator=(const LockstepBatch&) = delete;
+
+    // The sensors of each lane, to be handed to that lane's algorithm; their addresses never change
+    const ConcreteWallSensor& wallsSensor(std::size_t lane) const { return wallsSensors[lane]; }
+    const ConcreteDirtSensor& dirtSensor(std::size_t lane) const { return dirtSensors[lane]; }
+    const ConcreteBatteryMeter& batteryMeter(std::size_t lane) const { return batteryMeters[lane]; }
+
+    std::size_t lanes() const { return laneCount; }
+    bool active(std::size_t lane) const { return status[lane] == RunStatus::Working && numSteps[lane] < maxSteps; }
+    bool anyActive() const;
+
+    // Applies steps[lane] to every active lane; the entries of inactive lanes are ignored
+    void step(const std::vector<Step>& steps);
+
+    RunStatus laneStatus(std::size_t lane) const { return status[lane]; }
+    int laneSteps(std::size_t lane) const { return static_cast<int>(numSteps[lane]); }
+    int laneDirtLeft(std::size_t lane) const { return dirtLeft[lane]; }
+    bool laneInDock(std::size_t lane) const { return inDock[lane] != 0; }
+    std::vector<std::tuple<int, int>> laneHistory(std::size_t lane) const;
+
+private:
+    void updateSensors(std::size_t lane);
+
+    std::size_t laneCount;
+    std::size_t stride;  // cols + 2
+    std::size_t cellCount;
+    std::size_t maxSteps;
+    std::size_t maxBattery;
+    std::uint32_t dockCell;
+    std::uint32_t chargeAmount;
+
+    std::vector<std::uint8_t> wallMask;  // Shared, 1 for walls and the border
+    std::vector<std::uint8_t> dirt;      // Lane-major: dirt[lane * cellCount + cell]
+
+    // Per-lane state
+    std::vector<std::uint32_t> position;
+    std::vector<std::uint32_t> battery;
+    std::vector<std::uint32_t> numSteps;
+    std::vector<int> dirtLeft;
+    std::vector<std::uint8_t> inDock;
+    std::vector<RunStatus> status;
+    std::vector<std::vector<std::uint32_t>> history;
+
+    std::vector<ConcreteWallSensor> wallsSensors;
+    std::vector<ConcreteDirtSensor> dirtSensors;
+    std::vector<ConcreteBatteryMeter> batteryMeters;
+
+    // Scratch for one call of step()
+    std::vector<std::int32_t> moveOffset;
+    std::vector<std::uint8_t> moving;
+};
+
+#endif // LOCKSTEP_BATCH_H
@@ -0,0 +1,26 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <cstddef>
+#include <vector>
+
+// The NUMA nodes of the host and the CPUs of each that this process may run on, read from
+// /sys/devices/system/node. A host without that information is one node holding every allowed CPU.
+// Memory is placed by first touch, so a buffer written first by a thread pinned to a node lives on that node.
+class NumaTopology {
+public:
+    static NumaTopology detect();
+
+    std::size_t nodeCount() const { return nodeCpus.size(); }
+    const std::vector<int>& cpus(std::size_t node) const { return nodeCpus[node]; }
+    std::size_t cpuCount() const;
+
+    // Pins the calling thread to one CPU, or to every CPU of a node
+    static bool pinToCpu(int cpu);
+    bool pinToNode(std::size_t node) const;
+
+private:
+    std::vector<std::vector<int>> nodeCpus; // Nodes without allowed CPUs are left out
+};
+
+#endif // NUMA_TOPOLOGY_H
@@ -0,0 +1,206 @@
+#include "OutputWriter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint32_t kArchiveMagic = 0x414f4356;  // "VCOA"
+constexpr std::uint32_t kArchiveVersion = 1;
+constexpr std::size_t kArchiveBufferSize = 4 << 20;
+
+template <typename T>
+void appendRaw(std::string& buffer, const T& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readRaw(std::FILE* file, T& value) {
+    return std::fread(&value, sizeof(value), 1, file) == 1;
+}
+
+}  // namespace
+
+OutputWriter::~OutputWriter() {
+    finish();
+}
+
+bool OutputWriter::start(const std::string& archivePath) {
+    finish();
+    this->archivePath = archivePath;
+    stopping = false;
+    written = 0;
+    failed = 0;
+    archiveIndex.clear();
+    archiveBuffer.clear();
+
+    if (!archivePath.empty()) {
+        archive = std::fopen(archivePath.c_str(), "wb");
+        if (!archive) {
+            std::cerr << "Failed to open output archive " << archivePath << std::endl;
+            return false;
+        }
+        archiveBuffer.reserve(kArchiveBufferSize);
+        appendRaw(archiveBuffer, kArchiveMagic);
+        appendRaw(archiveBuffer, kArchiveVersion);
+        archiveOffset = archiveBuffer.size();
+    }
+
+    writerThread = std::thread(&OutputWriter::writerLoop, this);
+    return true;
+}
+
+void OutputWriter::submit(std::string fileName, std::string contents) {
+    {
+        std::lock_guard<std::mutex> guard(queueMutex);
+        queue.emplace_back(std::move(fileName), std::move(contents));
+    }
+    queueReady.notify_one();
+}
+
+std::size_t OutputWriter::finish() {
+    if (!writerThread.joinable()) {
+        return written;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_one();
+    writerThread.join();
+
+    if (archive) {
+        std::uint64_t indexOffset = archiveOffset;
+        for (const auto& entry : archiveIndex) {
+            appendRaw(archiveBuffer, static_cast<std::uint32_t>(entry.name.size()));
+            archiveBuffer.append(entry.name);
+            appendRaw(archiveBuffer, entry.offset);
+            appendRaw(archiveBuffer, entry.length);
+        }
+        appendRaw(archiveBuffer, indexOffset);
+        appendRaw(archiveBuffer, static_cast<std::uint32_t>(archiveIndex.size()));
+        appendRaw(archiveBuffer, kArchiveMagic);
+        flushArchiveBuffer();
+        std::fclose(archive);
+        archive = nullptr;
+    }
+
+    if (failed > 0) {
+        std::cerr << "Failed to write " << failed << " output files." << std::endl;
+    }
+    return written;
+}
+
+void OutputWriter::writerLoop() {
+    std::vector<std::pair<std::string, std::string>> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty() && stopping) {
+                break;
+            }
+            batch.swap(queue);
+        }
+
+        for (const auto& [fileName, contents] : batch) {
+            if (archive) {
+                appendToArchive(fileName, contents);
+            } else {
+                writeFile(fileName, contents);
+            }
+        }
+        batch.clear();
+    }
+}
+
+void OutputWriter::writeFile(const std::string& fileName, const std::string& contents) {
+    // One open and one write per file, no stream buffering in between
+    int fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        failed++;
+        return;
+    }
+    const char* data = contents.data();
+    std::size_t remaining = contents.size();
+    while (remaining > 0) {
+        ssize_t count = ::write(fd, data, remaining);
+        if (count <= 0) {
+            failed++;
+            ::close(fd);
+            return;
+        }
+        data += count;
+        remaining -= static_cast<std::size_t>(count);
+    }
+    ::close(fd);
+    written++;
+}
+
+void OutputWriter::appendToArchive(const std::string& fileName, const std::string& contents) {
+    archiveIndex.push_back({fileName, archiveOffset, contents.size()});
+    archiveBuffer.append(contents);
+    archiveOffset += contents.size();
+    written++;
+    if (archiveBuffer.size() >= kArchiveBufferSize) {
+        flushArchiveBuffer();
+    }
+}
+
+void OutputWriter::flushArchiveBuffer() {
+    if (!archiveBuffer.empty() && std::fwrite(archiveBuffer.data(), 1, archiveBuffer.size(), archive) != archiveBuffer.size()) {
+        failed++;
+    }
+    archiveBuffer.clear();
+}
+
+bool OutputWriter::readArchiveIndex(const std::string& archivePath, std::vector<ArchiveEntry>& entries) {
+    std::FILE* file = std::fopen(archivePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint64_t indexOffset = 0;
+    std::uint32_t count = 0;
+    std::uint32_t trailer = 0;
+    bool ok = readRaw(file, magic) && readRaw(file, version) && magic == kArchiveMagic && version == kArchiveVersion
+              && std::fseek(file, -static_cast<long>(sizeof(indexOffset) + sizeof(count) + sizeof(trailer)), SEEK_END) == 0
+              && readRaw(file, indexOffset) && readRaw(file, count) && readRaw(file, trailer) && trailer == kArchiveMagic
+              && std::fseek(file, static_cast<long>(indexOffset), SEEK_SET) == 0;
+
+    entries.clear();
+    for (std::uint32_t i = 0; ok && i < count; ++i) {
+        std::uint32_t nameLength = 0;
+        ArchiveEntry entry;
+        ok = readRaw(file, nameLength);
+        if (ok) {
+            entry.name.resize(nameLength);
+            ok = std::fread(entry.name.data(), 1, nameLength, file) == nameLength && readRaw(file, entry.offset) && readRaw(file, entry.length);
+        }
+        if (ok) {
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+bool OutputWriter::readArchiveEntry(const std::string& archivePath, const ArchiveEntry& entry, std::string& contents) {
+    std::FILE* file = std::fopen(archivePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    contents.resize(entry.length);
+    bool ok = std::fseek(file, static_cast<long>(entry.offset), SEEK_SET) == 0
+              && std::fread(contents.data(), 1, entry.length, file) == entry.length;
+    std::fclose(file);
+    return ok;
+}
@@ -0,0 +1,65 @@
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Writes the per-run output files on a dedicated thread so that simulation workers never block on the file system.
+// Workers hand over the finished text with submit(); the writer thread takes whole batches off the queue.
+// In archive mode all runs go into one packed file instead of one file each:
+//
+//   "VCOA" (u32) | version (u32) | run texts back to back | index | index offset (u64) | entry count (u32) | "VCOA" (u32)
+//
+// where every index entry is: name length (u32) | name | offset (u64) | length (u64).
+class OutputWriter {
+public:
+    struct ArchiveEntry {
+        std::string name;
+        std::uint64_t offset;
+        std::uint64_t length;
+    };
+
+    OutputWriter() = default;
+    ~OutputWriter();
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    // An empty archive path writes one file per run
+    bool start(const std::string& archivePath = "");
+    void submit(std::string fileName, std::string contents);
+    // Drains the queue, writes the archive index and stops the thread. Returns the number of outputs written.
+    std::size_t finish();
+
+    bool running() const { return writerThread.joinable(); }
+
+    // Reads the index of an archive written by finish()
+    static bool readArchiveIndex(const std::string& archivePath, std::vector<ArchiveEntry>& entries);
+    static bool readArchiveEntry(const std::string& archivePath, const ArchiveEntry& entry, std::string& contents);
+
+private:
+    void writerLoop();
+    void writeFile(const std::string& fileName, const std::string& contents);
+    void appendToArchive(const std::string& fileName, const std::string& contents);
+    void flushArchiveBuffer();
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::vector<std::pair<std::string, std::string>> queue;
+    bool stopping = false;
+    std::thread writerThread;
+
+    std::string archivePath;
+    std::FILE* archive = nullptr;
+    std::string archiveBuffer;
+    std::uint64_t archiveOffset = 0;
+    std::vector<ArchiveEntry> archiveIndex;
+    std::size_t written = 0;
+    std::size_t failed = 0;
+};
+
+#endif // OUTPUT_WRITER_H
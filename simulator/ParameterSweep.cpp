@@ -0,0 +1,125 @@
+#include "ParameterSweep.h"
+
+#include <algorithm>
+#include <charconv>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string_view>
+
+bool ParameterSweep::addAxis(const std::string& spec, std::string& error) {
+    std::size_t colon = spec.find(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == spec.size()) {
+        error = "expected <name>:<v1>,<v2>,... or <name>:<low>..<high>, got " + spec;
+        return false;
+    }
+
+    Axis axis;
+    axis.name = spec.substr(0, colon);
+    std::string values = spec.substr(colon + 1);
+
+    try {
+        std::size_t dots = values.find("..");
+        if (dots != std::string::npos) {
+            axis.isRange = true;
+            axis.low = std::stod(values.substr(0, dots));
+            axis.high = std::stod(values.substr(dots + 2));
+            if (axis.high < axis.low) {
+                error = "empty range for parameter " + axis.name;
+                return false;
+            }
+        } else {
+            std::stringstream stream(values);
+            std::string value;
+            while (std::getline(stream, value, ',')) {
+                axis.values.push_back(std::stod(value));
+            }
+        }
+    } catch (const std::exception&) {
+        error = "invalid value in " + spec;
+        return false;
+    }
+
+    axes.push_back(std::move(axis));
+    axisSpecs.push_back(spec);
+    return true;
+}
+
+void ParameterSweep::setSamples(std::size_t samples, std::uint64_t seed) {
+    this->samples = samples;
+    this->seed = seed;
+}
+
+std::vector<ParameterSet> ParameterSweep::configurations() const {
+    if (axes.empty()) {
+        return {ParameterSet{}};
+    }
+
+    std::vector<ParameterSet> result;
+    std::set<ParameterSet> seen;
+    if (samples > 0) {
+        // Distinct configurations only: a draw equal to an earlier one is drawn again, so the sample is never
+        // larger than the grid of the listed values
+        std::size_t distinct = samples;
+        if (std::none_of(axes.begin(), axes.end(), [](const Axis& axis) { return axis.isRange && axis.high > axis.low; })) {
+            std::size_t grid = 1;
+            for (const auto& axis : axes) {
+                std::size_t values = axis.isRange ? 1 : std::set<double>(axis.values.begin(), axis.values.end()).size();
+                grid = std::min(distinct, grid * values);
+            }
+            distinct = std::min(distinct, grid);
+        }
+        std::mt19937_64 rng(seed);
+        while (result.size() < distinct) {
+            ParameterSet parameters;
+            for (const auto& axis : axes) {
+                // Same reasoning as the task scheduler: derive values from raw engine output only
+                double unit = static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+                double value = axis.isRange ? axis.low + unit * (axis.high - axis.low)
+                                            : axis.values[rng() % axis.values.size()];
+                parameters.emplace_back(axis.name, value);
+            }
+            if (seen.insert(parameters).second) {
+                result.push_back(std::move(parameters));
+            }
+        }
+        return result;
+    }
+
+    // Full grid, the last axis varying fastest. A range contributes its two end points.
+    result.push_back(ParameterSet{});
+    for (const auto& axis : axes) {
+        std::vector<double> values = axis.isRange ? std::vector<double>{axis.low, axis.high} : axis.values;
+        std::vector<ParameterSet> expanded;
+        for (const auto& partial : result) {
+            for (double value : values) {
+                ParameterSet parameters = partial;
+                parameters.emplace_back(axis.name, value);
+                expanded.push_back(std::move(parameters));
+            }
+        }
+        result = std::move(expanded);
+    }
+    // A value listed twice would run the same configuration twice
+    std::vector<ParameterSet> unique;
+    for (auto& parameters : result) {
+        if (seen.insert(parameters).second) {
+            unique.push_back(std::move(parameters));
+        }
+    }
+    return unique;
+}
+
+std::string ParameterSweep::label(const ParameterSet& parameters) {
+    std::ostringstream text;
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+        if (i > 0) {
+            text << ';';
+        }
+        // Shortest text that reads back as the same double, so distinct values never share a label
+        char value[32];
+        auto end = std::to_chars(value, value + sizeof(value), parameters[i].second).ptr;
+        text << parameters[i].first << '=' << std::string_view(value, static_cast<std::size_t>(end - value));
+    }
+    return text.str();
+}
@@ -0,0 +1,46 @@
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// One configuration of a sweep: parameter name and value, in the order the axes were given
+using ParameterSet = std::vector<std::pair<std::string, double>>;
+
+// Expands the -param axes of a run into the list of configurations to simulate.
+// Axes are either a list of values ("name:1,2,3") or a range ("name:0.5..1").
+// Without -sweep_samples the configurations are the full grid of the listed values;
+// with it they are a seeded random sample, ranges being sampled uniformly.
+class ParameterSweep {
+public:
+    // Returns false and sets `error` if the spec cannot be parsed
+    bool addAxis(const std::string& spec, std::string& error);
+    void setSamples(std::size_t samples, std::uint64_t seed);
+
+    bool empty() const { return axes.empty(); }
+    // The axes as they were given, for the run manifest
+    const std::vector<std::string>& specs() const { return axisSpecs; }
+    // Always at least one configuration; the empty configuration when no axis was given
+    std::vector<ParameterSet> configurations() const;
+
+    static std::string label(const ParameterSet& parameters);
+
+private:
+    struct Axis {
+        std::string name;
+        std::vector<double> values;
+        bool isRange = false;
+        double low = 0;
+        double high = 0;
+    };
+
+    std::vector<Axis> axes;
+    std::vector<std::string> axisSpecs;
+    std::size_t samples = 0;
+    std::uint64_t seed = 0;
+};
+
+#endif // PARAMETER_SWEEP_H
@@ -0,0 +1,150 @@
+#include "PluginIndex.h"
+#include "FileHash.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+
+namespace {
+
+const char* const kIndexHeader = "# plugin-index v1";
+
+bool statLibrary(const std::string& libraryPath, std::uint64_t& size, std::int64_t& mtime) {
+    struct stat st;
+    if (::stat(libraryPath.c_str(), &st) != 0) {
+        return false;
+    }
+    size = static_cast<std::uint64_t>(st.st_size);
+    mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000ll + st.st_mtim.tv_nsec;
+    return true;
+}
+
+}  // namespace
+
+// One tab-separated line per plugin: path, size, mtime, hash, abi, valid, names (comma separated), error
+bool PluginIndex::load() {
+    entries.clear();
+    dirty = false;
+
+    std::ifstream file(indexPath);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kIndexHeader) {
+        return false;  // Unknown format, rebuilt from scratch on save
+    }
+
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 7) {
+            continue;
+        }
+
+        try {
+            Entry entry;
+            entry.size = std::stoull(fields[1]);
+            entry.mtime = std::stoll(fields[2]);
+            entry.hash = std::stoull(fields[3], nullptr, 16);
+            entry.abiVersion = std::stoi(fields[4]);
+            entry.valid = fields[5] == "1";
+            std::stringstream names(fields[6]);
+            std::string name;
+            while (std::getline(names, name, ',')) {
+                if (!name.empty()) {
+                    entry.algorithmNames.push_back(name);
+                }
+            }
+            if (fields.size() > 7) {
+                entry.error = fields[7];
+            }
+            entries[fields[0]] = std::move(entry);
+        } catch (const std::exception&) {
+            continue;  // A damaged line only costs a re-validation
+        }
+    }
+    return true;
+}
+
+bool PluginIndex::save() const {
+    if (!dirty || indexPath.empty()) {
+        return true;
+    }
+
+    // Write to a temporary and rename, so a concurrent reader never sees half an index
+    std::string temporaryPath = indexPath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << kIndexHeader << "\n";
+        for (const auto& [libraryPath, entry] : entries) {
+            file << libraryPath << '\t' << entry.size << '\t' << entry.mtime << '\t' << hashToHex(entry.hash) << '\t'
+                 << entry.abiVersion << '\t' << (entry.valid ? 1 : 0) << '\t';
+            for (std::size_t i = 0; i < entry.algorithmNames.size(); ++i) {
+                file << (i > 0 ? "," : "") << entry.algorithmNames[i];
+            }
+            file << '\t' << entry.error << "\n";
+        }
+        if (!file) {
+            return false;
+        }
+    }
+    return std::rename(temporaryPath.c_str(), indexPath.c_str()) == 0;
+}
+
+const PluginIndex::Entry* PluginIndex::lookup(const std::string& libraryPath) {
+    auto it = entries.find(libraryPath);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+
+    std::uint64_t size = 0;
+    std::int64_t mtime = 0;
+    if (!statLibrary(libraryPath, size, mtime)) {
+        return nullptr;
+    }
+    Entry& entry = it->second;
+    if (entry.size == size && entry.mtime == mtime) {
+        return &entry;
+    }
+
+    // Touched or copied over: still a hit if the content is the same
+    std::uint64_t hash = 0;
+    if (entry.size == size && hashFile(libraryPath, hash) && hash == entry.hash) {
+        entry.mtime = mtime;
+        dirty = true;
+        return &entry;
+    }
+    return nullptr;
+}
+
+void PluginIndex::update(const std::string& libraryPath, Entry entry) {
+    entries[libraryPath] = std::move(entry);
+    dirty = true;
+}
+
+bool PluginIndex::describe(const std::string& libraryPath, Entry& entry) {
+    return statLibrary(libraryPath, entry.size, entry.mtime) && hashFile(libraryPath, entry.hash);
+}
+
+void PluginIndex::prune() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (!std::filesystem::exists(it->first)) {
+            it = entries.erase(it);
+            dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
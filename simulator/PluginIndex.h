@@ -0,0 +1,47 @@
+#ifndef PLUGIN_INDEX_H
+#define PLUGIN_INDEX_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// On-disk record of the algorithm plugins that were already validated, so that unchanged
+// libraries are neither hashed nor probed again on the next start.
+// A plugin is identified by its path; size and mtime are checked first, the content hash
+// only when those changed.
+class PluginIndex {
+public:
+    struct Entry {
+        std::uint64_t size = 0;
+        std::int64_t mtime = 0;
+        std::uint64_t hash = 0;
+        int abiVersion = 0;
+        bool valid = false;
+        std::vector<std::string> algorithmNames;
+        std::string error; // Why validation failed, for invalid entries
+    };
+
+    explicit PluginIndex(std::string indexPath = "") : indexPath(std::move(indexPath)) {}
+
+    void setPath(const std::string& path) { indexPath = path; }
+    const std::string& path() const { return indexPath; }
+
+    bool load();
+    bool save() const;
+
+    // Cached entry for the library if it is unchanged since it was recorded, nullptr otherwise
+    const Entry* lookup(const std::string& libraryPath);
+    void update(const std::string& libraryPath, Entry entry);
+    // Fills size, mtime and hash of the library as it is on disk now
+    static bool describe(const std::string& libraryPath, Entry& entry);
+    // Drops entries whose library no longer exists
+    void prune();
+
+private:
+    std::string indexPath;
+    std::map<std::string, Entry> entries;
+    bool dirty = false;
+};
+
+#endif // PLUGIN_INDEX_H
@@ -0,0 +1,110 @@
+#include "PluginWatcher.h"
+
+#include <chrono>
+#include <filesystem>
+
+#include <sys/stat.h>
+
+void PluginGate::enter() {
+    std::unique_lock<std::mutex> lock(gateMutex);
+    changed.wait(lock, [this] { return !draining; });
+    inFlight++;
+}
+
+void PluginGate::leave() {
+    std::lock_guard<std::mutex> guard(gateMutex);
+    inFlight--;
+    changed.notify_all();
+}
+
+void PluginGate::drain() {
+    std::unique_lock<std::mutex> lock(gateMutex);
+    draining = true;
+    changed.wait(lock, [this] { return inFlight == 0; });
+}
+
+void PluginGate::resume() {
+    std::lock_guard<std::mutex> guard(gateMutex);
+    draining = false;
+    changed.notify_all();
+}
+
+void PluginWatcher::start(const std::string& directory, int intervalMs, ChangeHandler handler) {
+    stop();
+    this->directory = directory;
+    this->intervalMs = intervalMs;
+    this->handler = std::move(handler);
+    known = scan();
+    pending.clear();
+    stopping = false;
+    watchThread = std::thread(&PluginWatcher::watchLoop, this);
+}
+
+void PluginWatcher::stop() {
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (watchThread.joinable()) {
+        watchThread.join();
+    }
+}
+
+std::map<std::string, PluginWatcher::Stamp> PluginWatcher::scan() const {
+    std::map<std::string, Stamp> libraries;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (entry.path().extension() != ".so") {
+            continue;
+        }
+        struct stat st;
+        if (::stat(entry.path().c_str(), &st) == 0) {
+            libraries[entry.path().string()] = {static_cast<std::uint64_t>(st.st_size),
+                                                static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000ll + st.st_mtim.tv_nsec};
+        }
+    }
+    return libraries;
+}
+
+void PluginWatcher::watchLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait_for(lock, std::chrono::milliseconds(intervalMs), [this] { return stopping.load(); });
+            if (stopping) {
+                return;
+            }
+        }
+
+        std::map<std::string, Stamp> current = scan();
+
+        for (const auto& [library, stamp] : current) {
+            auto old = known.find(library);
+            if (old != known.end() && old->second == stamp) {
+                pending.erase(library);
+                continue;
+            }
+            auto waiting = pending.find(library);
+            if (waiting == pending.end() || waiting->second != stamp) {
+                pending[library] = stamp;  // Report it once it stops changing
+                continue;
+            }
+            pending.erase(waiting);
+            Change change = old == known.end() ? Change::Added : Change::Modified;
+            known[library] = stamp;
+            handler(library, change);
+        }
+
+        for (auto it = known.begin(); it != known.end();) {
+            if (current.count(it->first) == 0) {
+                std::string library = it->first;
+                it = known.erase(it);
+                pending.erase(library);
+                handler(library, Change::Removed);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
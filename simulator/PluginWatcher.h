@@ -0,0 +1,73 @@
+#ifndef PLUGIN_WATCHER_H
+#define PLUGIN_WATCHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+// Counts the tasks running code from one plugin library, so that the library can be drained
+// before it is unloaded: drain() stops new tasks from entering and waits for the running ones.
+class PluginGate {
+public:
+    void enter();
+    void leave();
+    void drain();
+    void resume();
+
+private:
+    std::mutex gateMutex;
+    std::condition_variable changed;
+    std::size_t inFlight = 0;
+    bool draining = false;
+};
+
+// RAII use of a plugin by one task
+class PluginUse {
+public:
+    explicit PluginUse(PluginGate& gate) : gate(gate) { gate.enter(); }
+    ~PluginUse() { gate.leave(); }
+    PluginUse(const PluginUse&) = delete;
+    PluginUse& operator=(const PluginUse&) = delete;
+
+private:
+    PluginGate& gate;
+};
+
+// Polls the algorithm directory and reports .so files that appeared, changed or disappeared.
+// A file is only reported once its size and mtime were the same on two consecutive polls,
+// so a library that is still being written is never picked up half-way.
+class PluginWatcher {
+public:
+    enum class Change { Added, Modified, Removed };
+    using ChangeHandler = std::function<void(const std::string& library, Change change)>;
+
+    ~PluginWatcher() { stop(); }
+
+    // Starts watching; the libraries present now are the baseline and are not reported
+    void start(const std::string& directory, int intervalMs, ChangeHandler handler);
+    void stop();
+
+private:
+    using Stamp = std::pair<std::uint64_t, std::int64_t>;
+
+    std::map<std::string, Stamp> scan() const;
+    void watchLoop();
+
+    std::string directory;
+    int intervalMs = 1000;
+    ChangeHandler handler;
+    std::map<std::string, Stamp> known;
+    std::map<std::string, Stamp> pending;
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::thread watchThread;
+};
+
+#endif // PLUGIN_WATCHER_H
@@ -0,0 +1,155 @@
+#include "ReplayVerifier.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr std::uint8_t kWallCell = 0xFF;
+
+bool fieldValue(std::string_view line, std::string_view name, std::string_view& value) {
+    if (line.substr(0, name.size()) != name || line.substr(name.size(), 3) != " = ") {
+        return false;
+    }
+    value = line.substr(name.size() + 3);
+    return true;
+}
+
+bool parseInt(std::string_view text, int& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+}  // namespace
+
+int scoreRun(int maxSteps, int numSteps, int dirtLeft, bool inDock, RunStatus status) {
+    if (status == RunStatus::Dead) {
+        return maxSteps + dirtLeft * 300 + 2000;
+    } else if (status == RunStatus::Finished && !inDock) {
+        return maxSteps + dirtLeft * 300 + 3000;
+    } else {
+        return numSteps + dirtLeft * 300 + (inDock ? 0 : 1000);
+    }
+}
+
+bool parseRecordedRun(std::string_view text, RecordedRun& run) {
+    int found = 0;
+    while (!text.empty()) {
+        std::size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        std::string_view value;
+        if (fieldValue(line, "NumSteps", value)) {
+            found += parseInt(value, run.numSteps);
+        } else if (fieldValue(line, "DirtLeft", value)) {
+            found += parseInt(value, run.dirtLeft);
+        } else if (fieldValue(line, "Status", value)) {
+            run.status = std::string(value);
+            found++;
+        } else if (fieldValue(line, "InDock", value)) {
+            run.inDock = value == "TRUE";
+            found++;
+        } else if (fieldValue(line, "Score", value)) {
+            found += parseInt(value, run.score);
+        } else if (line == "Steps:") {
+            std::size_t stepsEnd = text.find('\n');
+            run.steps = std::string(text.substr(0, stepsEnd));
+            if (!run.steps.empty() && run.steps.back() == '\r') {
+                run.steps.pop_back();
+            }
+            return found == 5;
+        }
+    }
+    return false;
+}
+
+ReplayOutcome replaySteps(const StoredHouse& house, std::string_view steps) {
+    ReplayOutcome outcome;
+    outcome.dirtLeft = house.initialDirt;
+    outcome.battery = house.maxBattery;
+
+    // One byte per cell with a wall border, so a move is an add and a load: the dirt level, or kWallCell
+    const std::ptrdiff_t stride = static_cast<std::ptrdiff_t>(house.cols) + 2;
+    std::vector<std::uint8_t> grid((house.rows + 2) * stride, kWallCell);
+    for (std::size_t x = 0; x < house.rows; ++x) {
+        const char* row = house.cells.data() + x * house.cols;
+        std::uint8_t* cells = grid.data() + (x + 1) * stride + 1;
+        for (std::size_t y = 0; y < house.cols; ++y) {
+            char cell = row[y];
+            cells[y] = cell == 'W' ? kWallCell : (cell >= '1' && cell <= '9') ? cell - '0' : 0;
+        }
+    }
+    const std::ptrdiff_t dock = (house.dockRow + 1) * stride + house.dockCol + 1;
+    const std::size_t chargeAmount = std::max<std::size_t>(1, house.maxBattery / 20);
+    const std::size_t maxSteps = house.maxSteps;
+
+    // Indexed by the step letter: North is y-1, East x+1, South y+1, West x-1, 's' stays
+    std::ptrdiff_t offset[128] = {};
+    bool isMove[128] = {};
+    offset['N'] = -1;
+    offset['E'] = stride;
+    offset['S'] = 1;
+    offset['W'] = -stride;
+    isMove['N'] = isMove['E'] = isMove['S'] = isMove['W'] = isMove['s'] = true;
+
+    std::uint8_t* cells = grid.data();
+    std::ptrdiff_t position = dock;
+    std::size_t battery = house.maxBattery;
+    std::size_t numSteps = 0;
+    int dirtLeft = house.initialDirt;
+    bool finished = false;
+
+    for (std::size_t i = 0; i < steps.size(); ++i) {
+        unsigned char letter = static_cast<unsigned char>(steps[i]);
+        if (letter == 'F' && i + 1 == steps.size()) {
+            finished = true;
+            break;
+        }
+        if (letter >= 128 || !isMove[letter]) {
+            outcome.error = "unexpected '" + std::string(1, steps[i]) + "' at step " + std::to_string(i + 1);
+            break;
+        }
+        if (numSteps == maxSteps) {
+            outcome.error = "more than MaxSteps = " + std::to_string(maxSteps) + " steps";
+            break;
+        }
+        std::ptrdiff_t next = position + offset[letter];
+        if (cells[next] == kWallCell) {
+            outcome.error = "move into a wall at step " + std::to_string(i + 1);
+            break;
+        }
+        position = next;
+        bool stay = letter == 's';
+        if (stay && cells[position] > 0) {
+            cells[position]--;
+            dirtLeft--;
+        }
+        if (stay && position == dock) {
+            battery = std::min(battery + chargeAmount, house.maxBattery);
+        } else if (battery > 0) {
+            battery--;
+        }
+        numSteps++;
+    }
+
+    outcome.numSteps = static_cast<int>(numSteps);
+    outcome.dirtLeft = dirtLeft;
+    outcome.inDock = position == dock;
+    outcome.battery = battery;
+    // A battery of 1 finishes before the first step, exactly like the simulator
+    if (finished || house.maxBattery == 1) {
+        outcome.status = RunStatus::Finished;
+    } else if (numSteps == maxSteps) {
+        outcome.status = RunStatus::Working;
+    } else {
+        outcome.status = RunStatus::Dead;
+    }
+    outcome.score = scoreRun(static_cast<int>(maxSteps), outcome.numSteps, outcome.dirtLeft, outcome.inDock, outcome.status);
+    return outcome;
+}
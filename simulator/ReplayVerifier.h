@@ -0,0 +1,44 @@
+#ifndef REPLAY_VERIFIER_H
+#define REPLAY_VERIFIER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "RunRecord.h"
+#include "SharedHouseStore.h"
+
+// Re-scores recorded runs without the plugin that produced them: the Steps string of a per-run output
+// file is applied to the house with the rules of MySimulator::advanceRun (moves, cleaning on Stay,
+// charging in the dock) and the result is scored again. Used by `simulator verify`.
+
+// The fields of one per-run output file, as written by MySimulator::writeSimulationOutput
+struct RecordedRun {
+    int numSteps = 0;
+    int dirtLeft = 0;
+    std::string status;
+    bool inDock = false;
+    int score = 0;
+    std::string steps;
+};
+
+struct ReplayOutcome {
+    int numSteps = 0;
+    int dirtLeft = 0;
+    RunStatus status = RunStatus::Working;
+    bool inDock = true;
+    std::size_t battery = 0;
+    int score = 0;
+    std::string error; // Set when the steps cannot have been produced by the simulator
+};
+
+// The scoring rule of the simulator, lower is better
+int scoreRun(int maxSteps, int numSteps, int dirtLeft, bool inDock, RunStatus status);
+
+bool parseRecordedRun(std::string_view text, RecordedRun& run);
+
+// The recorded steps do not include the move that killed a DEAD run, so a trace that ends early without 'F'
+// is replayed as DEAD, one that reaches maxSteps as WORKING.
+ReplayOutcome replaySteps(const StoredHouse& house, std::string_view steps);
+
+#endif // REPLAY_VERIFIER_H
@@ -0,0 +1,119 @@
+#include "ResultCache.h"
+#include "FileHash.h"
+
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+const char* const kCacheHeader = "# result-cache v3";
+
+// Stores of the same key from two threads of one simulator use different temporaries
+std::atomic<unsigned> temporaryCounter{0};
+
+// name=value pairs joined with ';', the values as hexadecimal floating point
+std::string exactParameters(const ParameterSet& parameters) {
+    std::string text;
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+        char value[40];
+        auto end = std::to_chars(value, value + sizeof(value), parameters[i].second, std::chars_format::hex).ptr;
+        text += (i > 0 ? ";" : "") + parameters[i].first + '=' + std::string(value, end);
+    }
+    return text;
+}
+
+}  // namespace
+
+// The whole key, so a hash collision is a miss and not somebody else's result. Parameter values are written
+// as hexadecimal floating point, which is exact: two configurations share an entry only if they are equal.
+// The last two fields are the fork step and the trunk configuration, 0 and empty for a full run.
+std::string ResultCache::keyLine(const Key& key) {
+    return "key\t" + std::to_string(kSimulationRulesVersion) + '\t' + hashToHex(key.houseHash) + '\t' + hashToHex(key.pluginHash) +
+           '\t' + key.algorithmName + '\t' + exactParameters(key.parameters) + '\t' + std::to_string(key.forkStep) + '\t' +
+           exactParameters(key.trunkParameters);
+}
+
+std::string ResultCache::entryPath(const Key& key) const {
+    std::string line = keyLine(key);
+    return (std::filesystem::path(cacheDirectory) / (hashToHex(hashBytes(line.data(), line.size())) + ".result")).string();
+}
+
+// Three lines: the header, the key and a tab-separated result line:
+//   result numSteps dirtLeft inDock status score dockRow dockCol steps
+bool ResultCache::lookup(const Key& key, Entry& entry) const {
+    if (!enabled()) {
+        return false;
+    }
+    std::ifstream file(entryPath(key));
+    std::string line;
+    if (!file || !std::getline(file, line) || line != kCacheHeader || !std::getline(file, line) || line != keyLine(key) ||
+        !std::getline(file, line)) {
+        return false;
+    }
+
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, '\t')) {
+        fields.push_back(field);
+    }
+    if (fields.size() == 8) {
+        fields.emplace_back();  // A run without steps
+    }
+    if (fields.size() != 9 || fields[0] != "result") {
+        return false;
+    }
+
+    try {
+        entry.numSteps = std::stoi(fields[1]);
+        entry.dirtLeft = std::stoi(fields[2]);
+        entry.inDock = fields[3] == "1";
+        if (!parseStatus(fields[4], entry.status)) {
+            return false;
+        }
+        entry.score = std::stoi(fields[5]);
+        entry.dockRow = std::stoi(fields[6]);
+        entry.dockCol = std::stoi(fields[7]);
+        entry.steps = fields[8];
+    } catch (const std::exception&) {
+        return false;  // A damaged entry is a miss, and replaced by the run
+    }
+    return true;
+}
+
+bool ResultCache::store(const Key& key, const Entry& entry) const {
+    if (!enabled()) {
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDirectory, ec);
+
+    std::string path = entryPath(key);
+    // Per process and store: simulators sharing the cache, and the workers of one, may store the same result at once
+    std::string temporaryPath = path + ".tmp" + std::to_string(::getpid()) + "." + std::to_string(temporaryCounter++);
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << kCacheHeader << "\n" << keyLine(key) << "\n";
+        file << "result\t" << entry.numSteps << '\t' << entry.dirtLeft << '\t' << (entry.inDock ? 1 : 0) << '\t' << statusName(entry.status)
+             << '\t' << entry.score << '\t' << entry.dockRow << '\t' << entry.dockCol << '\t' << entry.steps << "\n";
+        if (!file) {
+            std::filesystem::remove(temporaryPath, ec);
+            return false;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+    return true;
+}
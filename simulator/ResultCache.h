@@ -0,0 +1,60 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ParameterSweep.h"
+#include "RunRecord.h"
+
+// Bump whenever a change to the simulator can change the outcome of a run (movement, charging, scoring,
+// output format), so results cached by older simulators are no longer served
+constexpr int kSimulationRulesVersion = 1;
+
+// Persistent cache of run results, addressed by content: a run is identified by the hash of the house file,
+// the hash of the plugin binary, the algorithm, its sweep configuration, the fork it branched off if any and
+// kSimulationRulesVersion, so
+// nothing has to be invalidated by hand. Each result is one small file in the cache directory, named after
+// the hash of its key and written through a temporary and a rename, so concurrent simulators can share it.
+class ResultCache {
+public:
+    struct Key {
+        std::uint64_t houseHash = 0;
+        std::uint64_t pluginHash = 0;
+        std::string algorithmName;
+        ParameterSet parameters;  // Exact values, empty for an algorithm without parameters
+        // A run that branched off a -fork_at trunk is a different run from a full one of its configuration
+        std::size_t forkStep = 0;
+        ParameterSet trunkParameters;
+    };
+
+    // The outcome of a run and its trace: the docking station and the step letters of the output file
+    struct Entry {
+        int numSteps = 0;
+        int dirtLeft = 0;
+        bool inDock = true;
+        RunStatus status = RunStatus::Working;
+        int score = 0;
+        int dockRow = 0;
+        int dockCol = 0;
+        std::string steps;
+    };
+
+    explicit ResultCache(std::string directory = "") : cacheDirectory(std::move(directory)) {}
+
+    void setDirectory(const std::string& directory) { cacheDirectory = directory; }
+    bool enabled() const { return !cacheDirectory.empty(); }
+    const std::string& directory() const { return cacheDirectory; }
+
+    bool lookup(const Key& key, Entry& entry) const;
+    bool store(const Key& key, const Entry& entry) const;
+
+private:
+    std::string entryPath(const Key& key) const;
+    static std::string keyLine(const Key& key);
+
+    std::string cacheDirectory;
+};
+
+#endif // RESULT_CACHE_H
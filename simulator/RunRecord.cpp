@@ -0,0 +1,39 @@
+#include "RunRecord.h"
+
+const char* statusName(RunStatus status) {
+    switch (status) {
+        case RunStatus::Finished:
+            return "FINISHED";
+        case RunStatus::Dead:
+            return "DEAD";
+        case RunStatus::Working:
+            break;
+    }
+    return "WORKING";
+}
+
+bool parseStatus(std::string_view text, RunStatus& status) {
+    if (text == "WORKING") {
+        status = RunStatus::Working;
+    } else if (text == "FINISHED") {
+        status = RunStatus::Finished;
+    } else if (text == "DEAD") {
+        status = RunStatus::Dead;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::uint32_t NameTable::intern(const std::string& name) {
+    auto [found, inserted] = ids.try_emplace(name, static_cast<std::uint32_t>(names.size()));
+    if (inserted) {
+        names.push_back(name);
+    }
+    return found->second;
+}
+
+void NameTable::clear() {
+    names.clear();
+    ids.clear();
+}
@@ -0,0 +1,53 @@
+#ifndef RUN_RECORD_H
+#define RUN_RECORD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+enum class RunStatus : std::uint8_t { Working, Finished, Dead };
+
+// "WORKING", "FINISHED" or "DEAD", as written to the output files
+const char* statusName(RunStatus status);
+bool parseStatus(std::string_view text, RunStatus& status);
+
+// Gives every distinct name a dense 32-bit id, so records refer to houses, algorithms and sweep
+// configurations by id and the names are stored once
+class NameTable {
+public:
+    std::uint32_t intern(const std::string& name);
+    const std::string& name(std::uint32_t id) const { return names[id]; }
+    std::size_t size() const { return names.size(); }
+    void clear();
+
+private:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, std::uint32_t> ids;
+};
+
+// The outcome of one run, without its trace. Trivially copyable and 28 bytes, so the results of a whole
+// tournament are one contiguous array that can be sorted and aggregated without touching the names.
+struct RunRecord {
+    static constexpr std::uint32_t kNoId = 0xFFFFFFFFu;
+
+    std::uint32_t houseId = kNoId;
+    std::uint32_t algorithmId = kNoId;
+    std::uint32_t parametersId = kNoId;
+    std::int32_t numSteps = 0;
+    std::int32_t dirtLeft = 0;
+    std::int32_t score = 0;
+    RunStatus status = RunStatus::Working;
+    bool inDock = true;
+
+    // A slot whose task failed or did not run
+    bool empty() const { return algorithmId == kNoId; }
+};
+
+static_assert(std::is_trivially_copyable_v<RunRecord>, "RunRecord is copied as raw memory");
+static_assert(sizeof(RunRecord) == 28, "RunRecord layout changed");
+
+#endif // RUN_RECORD_H
@@ -0,0 +1,306 @@
+#include "SharedHouseStore.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint32_t kSegmentMagic = 0x53484356;  // "VCHS"
+constexpr std::uint32_t kSegmentVersion = 1;
+constexpr auto kAttachTimeout = std::chrono::seconds(30);
+
+struct SegmentHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t ready;  // Set last, with release semantics, once every record is written
+    std::uint32_t houseCount;
+    std::uint64_t totalSize;
+};
+
+struct HouseRecord {
+    std::uint64_t keyOffset;
+    std::uint64_t keyLength;
+    std::uint64_t descriptionOffset;
+    std::uint64_t descriptionLength;
+    std::uint64_t fileStamp;
+    std::uint64_t maxSteps;
+    std::uint64_t maxBattery;
+    std::uint64_t rows;
+    std::uint64_t cols;
+    std::uint64_t cellsOffset;
+    std::int32_t dockRow;
+    std::int32_t dockCol;
+    std::int32_t initialDirt;
+    std::int32_t reserved;
+};
+
+std::size_t alignUp(std::size_t value) {
+    return (value + 7) & ~static_cast<std::size_t>(7);
+}
+
+// The canonical path is the key, so processes started from different directories find the same house
+std::string houseKey(const std::string& houseFilePath) {
+    std::error_code ec;
+    auto canonical = std::filesystem::weakly_canonical(houseFilePath, ec);
+    return ec ? houseFilePath : canonical.string();
+}
+
+// Size and modification time of the house file, used to detect a segment built from stale files
+std::uint64_t fileStamp(const std::string& houseFilePath) {
+    struct stat st;
+    if (::stat(houseFilePath.c_str(), &st) != 0) {
+        return 0;
+    }
+    std::uint64_t mtime = static_cast<std::uint64_t>(st.st_mtim.tv_sec) * 1000000000ull + st.st_mtim.tv_nsec;
+    return (static_cast<std::uint64_t>(st.st_size) << 40) ^ mtime;
+}
+
+}  // namespace
+
+SharedHouseStore::~SharedHouseStore() {
+    close();
+}
+
+bool SharedHouseStore::openOrCreate(const std::string& name, const std::vector<std::string>& houseFiles, const HouseLoader& loader) {
+    close();
+    segmentName = (name.empty() || name[0] != '/') ? "/" + name : name;
+
+    int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd >= 0) {
+        creator = true;
+        bool ok = create(houseFiles, loader, fd);
+        ::close(fd);
+        if (ok) {
+            resolve(houseFiles);
+        } else {
+            shm_unlink(segmentName.c_str());
+            close();
+        }
+        return ok;
+    }
+    if (errno != EEXIST) {
+        std::cerr << "Cannot create shared house segment " << segmentName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    fd = shm_open(segmentName.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Cannot open shared house segment " << segmentName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    bool ok = attach(fd);
+    ::close(fd);
+    if (ok) {
+        resolve(houseFiles);
+    } else {
+        close();
+    }
+    return ok;
+}
+
+bool SharedHouseStore::create(const std::vector<std::string>& houseFiles, const HouseLoader& loader, int fd) {
+    std::vector<StoredHouse> parsed;
+    std::vector<std::string> parsedKeys;
+    std::vector<std::uint64_t> parsedStamps;
+    parsed.reserve(houseFiles.size());
+
+    for (const auto& houseFile : houseFiles) {
+        StoredHouse house;
+        if (!loader(houseFile, house)) {
+            continue;  // Unreadable houses are left out; the simulator falls back to parsing them itself
+        }
+        parsedKeys.push_back(houseKey(houseFile));
+        parsedStamps.push_back(fileStamp(houseFile));
+        parsed.push_back(std::move(house));
+    }
+
+    // Header, record table, then the variable-length strings and cell planes
+    std::size_t total = alignUp(sizeof(SegmentHeader)) + alignUp(sizeof(HouseRecord) * parsed.size());
+    for (std::size_t i = 0; i < parsed.size(); ++i) {
+        total += alignUp(parsedKeys[i].size() + 1);
+        total += alignUp(parsed[i].description.size() + 1);
+        total += alignUp(parsed[i].cells.size());
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        std::cerr << "Cannot size shared house segment " << segmentName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    void* mapped = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Cannot map shared house segment " << segmentName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    base = mapped;
+    mappedSize = total;
+
+    char* bytes = static_cast<char*>(base);
+    auto* header = reinterpret_cast<SegmentHeader*>(bytes);
+    auto* records = reinterpret_cast<HouseRecord*>(bytes + alignUp(sizeof(SegmentHeader)));
+    std::size_t cursor = alignUp(sizeof(SegmentHeader)) + alignUp(sizeof(HouseRecord) * parsed.size());
+
+    auto place = [&](const char* data, std::size_t length, bool terminate) {
+        std::size_t offset = cursor;
+        std::memcpy(bytes + offset, data, length);
+        if (terminate) {
+            bytes[offset + length] = '\0';
+        }
+        cursor += alignUp(length + (terminate ? 1 : 0));
+        return offset;
+    };
+
+    for (std::size_t i = 0; i < parsed.size(); ++i) {
+        const StoredHouse& house = parsed[i];
+        HouseRecord& record = records[i];
+        record.keyLength = parsedKeys[i].size();
+        record.keyOffset = place(parsedKeys[i].data(), parsedKeys[i].size(), true);
+        record.descriptionLength = house.description.size();
+        record.descriptionOffset = place(house.description.data(), house.description.size(), true);
+        record.fileStamp = parsedStamps[i];
+        record.maxSteps = house.maxSteps;
+        record.maxBattery = house.maxBattery;
+        record.rows = house.rows;
+        record.cols = house.cols;
+        record.cellsOffset = place(house.cells.data(), house.cells.size(), false);
+        record.dockRow = house.dockRow;
+        record.dockCol = house.dockCol;
+        record.initialDirt = house.initialDirt;
+        record.reserved = 0;
+    }
+
+    header->magic = kSegmentMagic;
+    header->version = kSegmentVersion;
+    header->houseCount = static_cast<std::uint32_t>(parsed.size());
+    header->totalSize = total;
+    std::atomic_ref<std::uint32_t>(header->ready).store(1, std::memory_order_release);
+
+    // From here on the houses are immutable for this process as well
+    mprotect(base, mappedSize, PROT_READ);
+    buildViews();
+    return true;
+}
+
+bool SharedHouseStore::attach(int fd) {
+    auto deadline = std::chrono::steady_clock::now() + kAttachTimeout;
+
+    // The creator may still be parsing; wait until the segment has its final size
+    struct stat st;
+    while (true) {
+        if (fstat(fd, &st) != 0) {
+            std::cerr << "Cannot stat shared house segment " << segmentName << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        if (st.st_size >= static_cast<off_t>(sizeof(SegmentHeader))) {
+            break;
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "Timed out waiting for shared house segment " << segmentName << std::endl;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    void* mapped = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Cannot map shared house segment " << segmentName << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    base = mapped;
+    mappedSize = static_cast<std::size_t>(st.st_size);
+
+    auto* header = static_cast<SegmentHeader*>(base);
+    while (std::atomic_ref<std::uint32_t>(header->ready).load(std::memory_order_acquire) == 0) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "Timed out waiting for shared house segment " << segmentName << std::endl;
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    if (header->magic != kSegmentMagic || header->version != kSegmentVersion || header->totalSize != mappedSize) {
+        std::cerr << "Shared house segment " << segmentName << " has an incompatible layout" << std::endl;
+        return false;
+    }
+
+    buildViews();
+    return true;
+}
+
+void SharedHouseStore::buildViews() {
+    const char* bytes = static_cast<const char*>(base);
+    const auto* header = reinterpret_cast<const SegmentHeader*>(bytes);
+    const auto* records = reinterpret_cast<const HouseRecord*>(bytes + alignUp(sizeof(SegmentHeader)));
+
+    keys.clear();
+    fileStamps.clear();
+    views.clear();
+    for (std::uint32_t i = 0; i < header->houseCount; ++i) {
+        const HouseRecord& record = records[i];
+        keys.emplace_back(bytes + record.keyOffset, record.keyLength);
+        fileStamps.push_back(record.fileStamp);
+        views.push_back(SharedHouseView{
+            bytes + record.descriptionOffset,
+            static_cast<std::size_t>(record.maxSteps),
+            static_cast<std::size_t>(record.maxBattery),
+            static_cast<std::size_t>(record.rows),
+            static_cast<std::size_t>(record.cols),
+            record.dockRow,
+            record.dockCol,
+            record.initialDirt,
+            bytes + record.cellsOffset});
+    }
+}
+
+void SharedHouseStore::resolve(const std::vector<std::string>& houseFiles) {
+    resolved.clear();
+    for (const auto& houseFile : houseFiles) {
+        resolved.emplace(houseFile, lookup(houseFile));
+    }
+}
+
+const SharedHouseView* SharedHouseStore::find(const std::string& houseFilePath) const {
+    auto known = resolved.find(houseFilePath);
+    return known != resolved.end() ? known->second : lookup(houseFilePath);
+}
+
+const SharedHouseView* SharedHouseStore::lookup(const std::string& houseFilePath) const {
+    if (!base) {
+        return nullptr;
+    }
+    std::string key = houseKey(houseFilePath);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] == key) {
+            return fileStamps[i] == fileStamp(houseFilePath) ? &views[i] : nullptr;
+        }
+    }
+    return nullptr;
+}
+
+void SharedHouseStore::close() {
+    if (base) {
+        munmap(base, mappedSize);
+    }
+    base = nullptr;
+    mappedSize = 0;
+    creator = false;
+    keys.clear();
+    fileStamps.clear();
+    views.clear();
+    resolved.clear();
+}
+
+void SharedHouseStore::unlink() {
+    if (!segmentName.empty()) {
+        shm_unlink(segmentName.c_str());
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef SHARED_HOUSE_STORE_H
+#define SHARED_HOUSE_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A parsed house in the flat form kept in the shared segment: one byte per cell,
+// row-major, ragged rows already padded with ' ' exactly like readHouseFile does.
+struct StoredHouse {
+    std::string description;
+    std::size_t maxSteps = 0;
+    std::size_t maxBattery = 0;
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    int dockRow = 0;
+    int dockCol = 0;
+    int initialDirt = 0;
+    std::vector<char> cells;
+};
+
+// Read-only view of one house inside the mapped segment.
+struct SharedHouseView {
+    const char* description;
+    std::size_t maxSteps;
+    std::size_t maxBattery;
+    std::size_t rows;
+    std::size_t cols;
+    int dockRow;
+    int dockCol;
+    int initialDirt;
+    const char* cells;
+};
+
+// Keeps every house of a run in one POSIX shared-memory segment so that several
+// simulator processes on the same host parse the houses once and share the pages.
+// The first process to open a given name builds the segment, later ones attach to it.
+// All references inside the segment are offsets from its base, so it can be mapped
+// at any address, and it is mapped PROT_READ once it has been published.
+class SharedHouseStore {
+public:
+    using HouseLoader = std::function<bool(const std::string& houseFilePath, StoredHouse& house)>;
+
+    SharedHouseStore() = default;
+    ~SharedHouseStore();
+    SharedHouseStore(const SharedHouseStore&) = delete;
+    SharedHouseStore& operator=(const SharedHouseStore&) = delete;
+
+    // Attaches to the segment `name`, or creates and fills it using `loader` if it does not exist yet.
+    // The paths in `houseFiles` are resolved to their houses here, once, so that finding them later costs
+    // no system calls.
+    bool openOrCreate(const std::string& name, const std::vector<std::string>& houseFiles, const HouseLoader& loader);
+    // Returns nullptr if the house is not in the segment or its file changed since the segment was built,
+    // as of when the segment was opened for the paths passed to openOrCreate.
+    const SharedHouseView* find(const std::string& houseFilePath) const;
+    void close();
+    // Removes the segment name; processes that already mapped it keep their mapping.
+    void unlink();
+
+    bool isOpen() const { return base != nullptr; }
+    bool isCreator() const { return creator; }
+    std::size_t size() const { return views.size(); }
+
+private:
+    bool create(const std::vector<std::string>& houseFiles, const HouseLoader& loader, int fd);
+    bool attach(int fd);
+    void buildViews();
+    void resolve(const std::vector<std::string>& houseFiles);
+    // Matches the canonical path and the file's stamp against the segment
+    const SharedHouseView* lookup(const std::string& houseFilePath) const;
+
+    std::string segmentName;
+    void* base = nullptr;
+    std::size_t mappedSize = 0;
+    bool creator = false;
+    std::vector<std::string> keys;
+    std::vector<std::uint64_t> fileStamps;
+    std::vector<SharedHouseView> views;
+    std::unordered_map<std::string, const SharedHouseView*> resolved;  // By the path as given, nullptr if stale
+};
+
+#endif // SHARED_HOUSE_STORE_H
@@ -0,0 +1,145 @@
+#include "SimulatorServer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kPollIntervalMs = 200;
+
+bool sendAll(int fd, const std::string& data) {
+    const char* bytes = data.data();
+    std::size_t remaining = data.size();
+    while (remaining > 0) {
+        ssize_t count = ::send(fd, bytes, remaining, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        bytes += count;
+        remaining -= static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+}  // namespace
+
+SimulatorServer::~SimulatorServer() {
+    stop();
+    joinClients(false);
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        ::unlink(socketPath.c_str());
+    }
+}
+
+bool SimulatorServer::listen(const std::string& socketPath) {
+    sockaddr_un address{};
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socketPath << std::endl;
+        return false;
+    }
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "Cannot create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(socketPath.c_str());  // A stale socket file from a previous daemon
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listenFd, 16) != 0) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    this->socketPath = socketPath;
+    return true;
+}
+
+void SimulatorServer::serve(const RequestHandler& handler) {
+    while (!stopping) {
+        pollfd listenPoll{listenFd, POLLIN, 0};
+        int ready = ::poll(&listenPoll, 1, kPollIntervalMs);
+        if (ready <= 0) {
+            continue;  // Timeout or signal: check whether we were asked to stop
+        }
+
+        int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+
+        joinClients(true);
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        clients.push_back(Client{std::thread(&SimulatorServer::handleClient, this, clientFd, std::cref(handler), done), done});
+    }
+
+    joinClients(false);
+}
+
+void SimulatorServer::joinClients(bool finishedOnly) {
+    for (auto it = clients.begin(); it != clients.end();) {
+        if (finishedOnly && !*it->done) {
+            ++it;
+            continue;
+        }
+        if (it->thread.joinable()) {
+            it->thread.join();
+        }
+        it = clients.erase(it);
+    }
+}
+
+void SimulatorServer::handleClient(int clientFd, const RequestHandler& handler, std::shared_ptr<std::atomic<bool>> done) {
+    std::mutex sendMutex;
+    bool connected = true;
+    Reply reply = [&](const std::string& line) {
+        std::lock_guard<std::mutex> guard(sendMutex);
+        connected = connected && sendAll(clientFd, line + "\n");
+        return connected;
+    };
+
+    std::string pending;
+    char buffer[4096];
+    bool open = true;
+    while (open && !stopping) {
+        pollfd clientPoll{clientFd, POLLIN, 0};
+        int ready = ::poll(&clientPoll, 1, kPollIntervalMs);
+        if (ready <= 0) {
+            continue;
+        }
+
+        ssize_t count = ::recv(clientFd, buffer, sizeof(buffer), 0);
+        if (count <= 0) {
+            break;
+        }
+        pending.append(buffer, static_cast<std::size_t>(count));
+
+        std::size_t newline;
+        while (open && (newline = pending.find('\n')) != std::string::npos) {
+            std::string request = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!request.empty() && request.back() == '\r') {
+                request.pop_back();
+            }
+            if (!request.empty()) {
+                open = handler(request, reply);
+            }
+        }
+    }
+
+    ::close(clientFd);
+    *done = true;
+}
@@ -0,0 +1,47 @@
+#ifndef SIMULATOR_SERVER_H
+#define SIMULATOR_SERVER_H
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Line-based request server on a Unix domain socket, used by the simulator's daemon mode.
+// Every client gets its own thread; each request line is passed to the handler together with
+// a reply function that sends one line back (and returns false once the client is gone).
+class SimulatorServer {
+public:
+    using Reply = std::function<bool(const std::string& line)>;
+    // Returns false to close the connection
+    using RequestHandler = std::function<bool(const std::string& request, const Reply& reply)>;
+
+    SimulatorServer() = default;
+    ~SimulatorServer();
+    SimulatorServer(const SimulatorServer&) = delete;
+    SimulatorServer& operator=(const SimulatorServer&) = delete;
+
+    bool listen(const std::string& socketPath);
+    // Accepts clients until stop() is called, then waits for the open connections to end
+    void serve(const RequestHandler& handler);
+    void stop() { stopping = true; }
+    bool stopped() const { return stopping; }
+
+private:
+    struct Client {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+
+    void handleClient(int clientFd, const RequestHandler& handler, std::shared_ptr<std::atomic<bool>> done);
+    void joinClients(bool finishedOnly);
+
+    std::string socketPath;
+    int listenFd = -1;
+    std::atomic<bool> stopping{false};
+    std::list<Client> clients;
+};
+
+#endif // SIMULATOR_SERVER_H
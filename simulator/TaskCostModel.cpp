@@ -0,0 +1,126 @@
+#include "TaskCostModel.h"
+#include "FileHash.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const char* const kHistoryHeader = "# task-history v2";
+// Weight of a new timing in the moving average; timings are noisy, houses and plugins rarely change
+constexpr double kNewTimingWeight = 0.3;
+// Seconds per unit assumed before anything was timed; only the order of the estimates matters then
+constexpr double kDefaultSecondsPerUnit = 1e-7;
+
+}  // namespace
+
+double TaskCostModel::sizeUnits(const HouseShape& house) {
+    // A battery of 1 finishes before the first step
+    double steps = house.maxBattery <= 1 ? 0.0 : static_cast<double>(house.maxSteps);
+    return steps + static_cast<double>(house.rows * house.cols);
+}
+
+bool TaskCostModel::load() {
+    timings.clear();
+    algorithmTotals.clear();
+    totals = {0, 0};
+    dirty = false;
+
+    std::ifstream file(historyPath);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line != kHistoryHeader) {
+        return false;  // Unknown format, started over on save
+    }
+
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 6) {
+            continue;
+        }
+
+        try {
+            Timing timing;
+            std::uint64_t hash = std::stoull(fields[2], nullptr, 16);
+            timing.seconds = std::stod(fields[3]);
+            timing.units = std::stod(fields[4]);
+            timing.runs = std::stoul(fields[5]);
+            if (timing.seconds < 0 || timing.units < 0) {
+                continue;
+            }
+            timings[{fields[0], fields[1], hash}] = timing;
+            addToTotals(fields[0], timing.seconds, timing.units, 1);
+        } catch (const std::exception&) {
+            continue;  // A damaged line only costs one estimate
+        }
+    }
+    return true;
+}
+
+bool TaskCostModel::save() const {
+    if (!dirty || historyPath.empty()) {
+        return true;
+    }
+
+    // Write to a temporary and rename, so a concurrent reader never sees half a history
+    std::string temporaryPath = historyPath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << kHistoryHeader << "\n";
+        for (const auto& [key, timing] : timings) {
+            file << std::get<0>(key) << '\t' << std::get<1>(key) << '\t' << hashToHex(std::get<2>(key)) << '\t' << timing.seconds << '\t' << timing.units << '\t'
+                 << timing.runs << "\n";
+        }
+        if (!file) {
+            return false;
+        }
+    }
+    return std::rename(temporaryPath.c_str(), historyPath.c_str()) == 0;
+}
+
+double TaskCostModel::estimate(const std::string& algorithmName, const std::string& configuration, const HouseShape& house) const {
+    auto timed = timings.find({algorithmName, configuration, house.hash});
+    if (timed != timings.end()) {
+        return timed->second.seconds;
+    }
+
+    double secondsPerUnit = kDefaultSecondsPerUnit;
+    auto algorithm = algorithmTotals.find(algorithmName);
+    if (algorithm != algorithmTotals.end() && algorithm->second.second > 0) {
+        secondsPerUnit = algorithm->second.first / algorithm->second.second;
+    } else if (totals.second > 0) {
+        secondsPerUnit = totals.first / totals.second;
+    }
+    return secondsPerUnit * sizeUnits(house);
+}
+
+void TaskCostModel::record(const std::string& algorithmName, const std::string& configuration, const HouseShape& house, double seconds) {
+    Timing& timing = timings[{algorithmName, configuration, house.hash}];
+    addToTotals(algorithmName, timing.seconds, timing.units, -1);
+    timing.seconds = timing.runs == 0 ? seconds : (1 - kNewTimingWeight) * timing.seconds + kNewTimingWeight * seconds;
+    timing.units = sizeUnits(house);
+    timing.runs++;
+    addToTotals(algorithmName, timing.seconds, timing.units, 1);
+    dirty = true;
+}
+
+void TaskCostModel::addToTotals(const std::string& algorithmName, double seconds, double units, double sign) {
+    auto& algorithm = algorithmTotals[algorithmName];
+    algorithm.first += sign * seconds;
+    algorithm.second += sign * units;
+    totals.first += sign * seconds;
+    totals.second += sign * units;
+}
@@ -0,0 +1,57 @@
+#ifndef TASK_COST_MODEL_H
+#define TASK_COST_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+
+// What the cost model knows about a house before it is loaded: its header and a hash of its contents
+struct HouseShape {
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+    std::size_t maxSteps = 0;
+    std::size_t maxBattery = 0;
+    std::uint64_t hash = 0;
+};
+
+// Estimates how long one house x algorithm run takes, so the scheduler can start the longest runs first.
+// Runs that were timed before are estimated from their recorded time; other runs from the size of the
+// house (maxSteps and area) times the seconds per unit of size this algorithm took on the houses it was
+// timed on. A sweep configuration is timed on its own, keyed by its ParameterSweep::label (empty without
+// parameters). The timings are kept in a small history file, one tab-separated line per algorithm,
+// configuration and house: algorithm, configuration, house hash, seconds (moving average), size units, runs.
+class TaskCostModel {
+public:
+    explicit TaskCostModel(std::string historyPath = "") : historyPath(std::move(historyPath)) {}
+
+    void setPath(const std::string& path) { historyPath = path; }
+
+    bool load();
+    bool save() const;
+
+    double estimate(const std::string& algorithmName, const std::string& configuration, const HouseShape& house) const;
+    void record(const std::string& algorithmName, const std::string& configuration, const HouseShape& house, double seconds);
+
+    // Size of a run in the model's units: the steps it may take plus the cells it copies
+    static double sizeUnits(const HouseShape& house);
+
+private:
+    struct Timing {
+        double seconds = 0;
+        double units = 0;
+        std::size_t runs = 0;
+    };
+
+    void addToTotals(const std::string& algorithmName, double seconds, double units, double sign);
+
+    std::string historyPath;
+    std::map<std::tuple<std::string, std::string, std::uint64_t>, Timing> timings;
+    std::map<std::string, std::pair<double, double>> algorithmTotals; // Seconds and units over all timed houses
+    std::pair<double, double> totals{0, 0};
+    bool dirty = false;
+};
+
+#endif // TASK_COST_MODEL_H
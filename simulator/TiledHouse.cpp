@@ -0,0 +1,92 @@
+#include "TiledHouse.h"
+
+#include <algorithm>
+
+TiledHouse::TiledHouse(std::size_t rows, std::size_t cols, const char* cells)
+    : rowCount(rows), colCount(cols), tileCols((cols + kTileSide - 1) >> kTileShift) {
+    std::size_t tileRows = (rows + kTileSide - 1) >> kTileShift;
+    directory.resize(tileRows * tileCols);
+    for (std::size_t slot = 0; slot < directory.size(); ++slot) {
+        directory[slot] = copyTile(cells, slot);
+    }
+}
+
+TiledHouse TiledHouse::overlay(std::size_t rows, std::size_t cols, const char* cells) {
+    TiledHouse house;
+    house.rowCount = rows;
+    house.colCount = cols;
+    house.tileCols = (cols + kTileSide - 1) >> kTileShift;
+    house.directory.assign(((rows + kTileSide - 1) >> kTileShift) * house.tileCols, kSharedTile);
+    house.shared = cells;
+    return house;
+}
+
+std::uint32_t TiledHouse::copyTile(const char* cells, std::size_t slot) {
+    std::size_t firstRow = (slot / tileCols) << kTileShift;
+    std::size_t lastRow = std::min(rowCount, firstRow + kTileSide);
+    std::size_t firstCol = (slot % tileCols) << kTileShift;
+    std::size_t width = std::min(colCount, firstCol + kTileSide) - firstCol;
+    bool open = false;
+    for (std::size_t x = firstRow; x < lastRow && !open; ++x) {
+        const char* row = cells + x * colCount + firstCol;
+        open = std::any_of(row, row + width, [](char cell) { return cell != 'W'; });
+    }
+    if (!open) {
+        return kNoTile;
+    }
+
+    // The part of a border tile outside the house is wall
+    auto tile = static_cast<std::uint32_t>(tiles.size() / kTileCells);
+    tiles.resize(tiles.size() + kTileCells, 'W');
+    for (std::size_t x = firstRow; x < lastRow; ++x) {
+        std::copy_n(cells + x * colCount + firstCol, width, tiles.begin() + offset(tile, x, firstCol));
+    }
+    return tile;
+}
+
+TiledHouse TiledHouse::fromRows(const std::vector<std::vector<char>>& house) {
+    std::size_t rows = house.size();
+    std::size_t cols = house.empty() ? 0 : house[0].size();
+    std::vector<char> cells(rows * cols, 'W');
+    for (std::size_t x = 0; x < rows; ++x) {
+        std::copy_n(house[x].begin(), std::min(cols, house[x].size()), cells.begin() + x * cols);
+    }
+    return TiledHouse(rows, cols, cells.data());
+}
+
+std::vector<std::pair<std::uint32_t, char>> TiledHouse::changedCells(const TiledHouse& original) const {
+    std::vector<std::pair<std::uint32_t, char>> changed;
+    for (std::size_t slot = 0; slot < directory.size(); ++slot) {
+        // A tile not stored here is the same as in the original: all wall, or still shared
+        std::uint32_t tile = directory[slot];
+        if (tile >= kSharedTile) {
+            continue;
+        }
+        const char* now = tiles.data() + static_cast<std::size_t>(tile) * kTileCells;
+        std::uint32_t originalTile = original.directory[slot];
+        if (originalTile < kSharedTile &&
+            std::equal(now, now + kTileCells, original.tiles.data() + static_cast<std::size_t>(originalTile) * kTileCells)) {
+            continue;
+        }
+        std::size_t firstRow = (slot / tileCols) << kTileShift;
+        std::size_t firstCol = (slot % tileCols) << kTileShift;
+        for (std::size_t i = 0; i < kTileCells; ++i) {
+            std::size_t x = firstRow + (i >> kTileShift);
+            std::size_t y = firstCol + (i & (kTileSide - 1));
+            if (x < rowCount && y < colCount && now[i] != original.at(x, y)) {
+                changed.emplace_back(static_cast<std::uint32_t>(x * colCount + y), now[i]);
+            }
+        }
+    }
+    return changed;
+}
+
+std::vector<std::vector<char>> TiledHouse::toRows() const {
+    std::vector<std::vector<char>> house(rowCount, std::vector<char>(colCount));
+    for (std::size_t x = 0; x < rowCount; ++x) {
+        for (std::size_t y = 0; y < colCount; ++y) {
+            house[x][y] = at(x, y);
+        }
+    }
+    return house;
+}
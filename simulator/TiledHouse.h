@@ -0,0 +1,76 @@
+#ifndef TILED_HOUSE_H
+#define TILED_HOUSE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A house as fixed-size square tiles, stored only where the tile has a cell that is not a wall. A directory
+// with one entry per tile position maps it to its tile, or to none for an all-wall tile, so a lookup is two
+// shifts and two loads, and the memory of a house (and the copy every run makes) grows with its floor area
+// and not with its bounding box. Cells outside the house, and all cells of a missing tile, read as 'W'.
+// An overlay reads a stored house in place instead and copies a tile only when one of its cells is first set,
+// so a run holds just the tiles it cleaned in.
+class TiledHouse {
+public:
+    static constexpr std::size_t kTileShift = 4;
+    static constexpr std::size_t kTileSide = std::size_t{1} << kTileShift;  // 16 x 16 cells, 256 bytes
+    static constexpr std::size_t kTileCells = kTileSide * kTileSide;
+    static constexpr std::uint32_t kNoTile = 0xFFFFFFFFu;
+    static constexpr std::uint32_t kSharedTile = 0xFFFFFFFEu;  // Not copied yet, read from the stored house
+
+    TiledHouse() = default;
+    // From row-major cells, `cols` to a row
+    TiledHouse(std::size_t rows, std::size_t cols, const char* cells);
+    static TiledHouse fromRows(const std::vector<std::vector<char>>& house);
+    // Copy-on-write over row-major `cells`, which must outlive the house and all of its copies
+    static TiledHouse overlay(std::size_t rows, std::size_t cols, const char* cells);
+
+    std::size_t rows() const { return rowCount; }
+    std::size_t cols() const { return colCount; }
+    std::size_t tileCount() const { return tiles.size() / kTileCells; }
+    std::size_t memoryBytes() const { return directory.size() * sizeof(std::uint32_t) + tiles.size(); }
+
+    char at(std::size_t x, std::size_t y) const {
+        std::uint32_t tile = directory[(x >> kTileShift) * tileCols + (y >> kTileShift)];
+        if (tile < kSharedTile) {
+            return tiles[offset(tile, x, y)];
+        }
+        return tile == kNoTile || x >= rowCount || y >= colCount ? 'W' : shared[x * colCount + y];
+    }
+    bool isWall(std::size_t x, std::size_t y) const { return at(x, y) == 'W'; }
+    // Only cells of stored tiles can change; the walls of a run never do. The first change to a tile of an
+    // overlay copies it in, or marks it as missing if it is all wall
+    void set(std::size_t x, std::size_t y, char cell) {
+        std::size_t slot = (x >> kTileShift) * tileCols + (y >> kTileShift);
+        if (directory[slot] == kSharedTile) {
+            directory[slot] = copyTile(shared, slot);
+        }
+        if (directory[slot] != kNoTile) {
+            tiles[offset(directory[slot], x, y)] = cell;
+        }
+    }
+
+    // The cells that differ from `original`, a house this one was copied from, as (row * cols + col, cell)
+    std::vector<std::pair<std::uint32_t, char>> changedCells(const TiledHouse& original) const;
+    // Dense rows, for the writers of whole houses
+    std::vector<std::vector<char>> toRows() const;
+
+private:
+    static std::size_t offset(std::uint32_t tile, std::size_t x, std::size_t y) {
+        return static_cast<std::size_t>(tile) * kTileCells + ((x & (kTileSide - 1)) << kTileShift) + (y & (kTileSide - 1));
+    }
+
+    // Appends the tile at `slot` of the row-major `cells`, the part outside the house as wall, and returns its index
+    std::uint32_t copyTile(const char* cells, std::size_t slot);
+
+    std::size_t rowCount = 0;
+    std::size_t colCount = 0;
+    std::size_t tileCols = 0;
+    std::vector<std::uint32_t> directory; // Tile row-major, kNoTile for all-wall tiles, kSharedTile as above
+    std::vector<char> tiles;              // kTileCells per stored tile, cell row-major inside the tile
+    const char* shared = nullptr;         // The stored house of an overlay
+};
+
+#endif // TILED_HOUSE_H
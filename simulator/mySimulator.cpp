@@ -8,12 +8,22 @@
 
 #include <filesystem>
 #include <future>
+#include <atomic>
+#include <random>
+#include <csignal>
+#include <chrono>
+#include <iomanip>
 
 
 
+// Text (.house) and binary (.houseb) houses; the loader tells them apart by content
+bool MySimulator::isHouseFile(const std::filesystem::path& path) {
+    return path.extension() == ".house" || path.extension() == kBinaryHouseExtension;
+}
+
 bool MySimulator::readHouseFile(const std::string& houseFilePath, std::vector<std::vector<char>>& house) {
 
-    std::ifstream file(houseFilePath);
+    std::ifstream file(houseFilePath, std::ios::binary);
 
     if (!file) {
 
@@ -23,39 +33,60 @@ bool MySimulator::readHouseFile(const std::string& houseFilePath, std::vector<st
 
     }
 
-
-
     inputFileName = houseFilePath;
 
-    std::string line;
-
-    std::getline(file, houseName); // Line 1: house name / description
-
-
-
-    std::getline(file, line); // Line 2: MaxSteps
-
-    std::stringstream(line.substr(line.find('=') + 1)) >> maxSteps;
-
-
-
-    std::getline(file, line); // Line 3: MaxBattery
-
-    std::stringstream(line.substr(line.find('=') + 1)) >> maxBattery;
-
-
-
-    std::getline(file, line); // Line 4: Rows
-
-    std::stringstream(line.substr(line.find('=') + 1)) >> rows;
-
-
-
-    std::getline(file, line); // Line 5: Cols
-
-    std::stringstream(line.substr(line.find('=') + 1)) >> cols;
+    // The whole file is read at once and split in place; rows are then scanned in bulk by scanHouseRow
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
 
+    if (isBinaryHouse(contents.data(), contents.size())) {
+        StoredHouse stored;
+        std::string error;
+        if (!decodeBinaryHouse(contents.data(), contents.size(), stored, error)) {
+            std::cerr << "Error: " << houseFilePath << ": " << error << std::endl;
+            return false;
+        }
+        SharedHouseView view{stored.description.c_str(), stored.maxSteps, stored.maxBattery, stored.rows, stored.cols,
+                             stored.dockRow, stored.dockCol, stored.initialDirt, stored.cells.data()};
+        TiledHouse tiled;
+        applyHouse(houseFilePath, view, tiled);
+        house = tiled.toRows();
+        std::cout << "Successfully read house file: " << houseFilePath << std::endl;
+        return true;
+    }
 
+    std::size_t cursor = 0;
+    // Same lines as std::getline: up to the next '\n', empty once the input is exhausted
+    auto nextLine = [&](const char*& begin, std::size_t& length) {
+        if (cursor >= contents.size()) {
+            begin = contents.data() + contents.size();
+            length = 0;
+            return false;
+        }
+        std::size_t end = contents.find('\n', cursor);
+        if (end == std::string::npos) {
+            end = contents.size();
+        }
+        begin = contents.data() + cursor;
+        length = end - cursor;
+        cursor = end + 1;
+        return true;
+    };
+    auto headerValue = [&](auto& value) {
+        const char* begin;
+        std::size_t length;
+        nextLine(begin, length);
+        std::string line(begin, length);
+        std::stringstream(line.substr(line.find('=') + 1)) >> value;
+    };
+
+    const char* begin;
+    std::size_t length;
+    nextLine(begin, length); // Line 1: house name / description
+    houseName.assign(begin, length);
+    headerValue(maxSteps); // Line 2: MaxSteps
+    headerValue(maxBattery); // Line 3: MaxBattery
+    headerValue(rows); // Line 4: Rows
+    headerValue(cols); // Line 5: Cols
 
     // Read the house structure
 
@@ -66,54 +97,140 @@ bool MySimulator::readHouseFile(const std::string& houseFilePath, std::vector<st
     house = std::vector<std::vector<char>>(rows, std::vector<char>(cols, ' '));
 
     for (std::size_t i = 0; i < rows; ++i) {
+        if (!nextLine(begin, length)) {
+            continue;
+        }
+        std::size_t width = std::min(length, cols);
+        std::copy_n(begin, width, house[i].begin());
+        RowScan scan = scanHouseRow(begin, width);
+        initialDirtLevel += scan.dirtSum; // Sum the dirt levels
+        if (scan.dockColumn >= 0) {
+            DockingFound = true;
+            dockingStation = {i, scan.dockColumn};
+            currentPosition = dockingStation;
+        }
+    }
+
 
-        if (std::getline(file, line)) {
 
-            for (std::size_t j = 0; j < line.size() && j < cols; ++j) {
+    if (!DockingFound) {
+
+        std::cerr << "Error: No Docking Station Was Found in " << houseFilePath << std::endl;
 
-                house[i][j] = line[j];
+        return false;
 
-                if (line[j] == 'D') {
+    }
 
-                    DockingFound = true;
 
-                    dockingStation = {i, j};
 
-                    currentPosition = dockingStation;
+    std::cout << "Successfully read house file: " << houseFilePath << std::endl;
 
-                } else if (line[j] >= '1' && line[j] <= '9') {
+    return true;
 
-                    initialDirtLevel += line[j] - '0'; // Sum the dirt levels
+}
 
-                }
 
-            }
 
+// Takes the house from the shared segment when one is attached, or from the houses kept warm by
+// the daemon mode, and parses the file otherwise
+bool MySimulator::loadHouse(const std::string& houseFilePath, TiledHouse& house) {
+    // With -numa the house is copied from the replica on its home node, where its tasks run
+    for (const auto& replica : numaReplicas) {
+        auto found = replica.find(houseFilePath);
+        if (found != replica.end()) {
+            const StoredHouse& stored = found->second;
+            SharedHouseView view{stored.description.c_str(), stored.maxSteps, stored.maxBattery, stored.rows, stored.cols,
+                                 stored.dockRow, stored.dockCol, stored.initialDirt, stored.cells.data()};
+            applyHouse(houseFilePath, view, house);
+            return true;
         }
-
     }
 
+    if (const SharedHouseView* shared = sharedHouses.find(houseFilePath)) {
+        applyHouse(houseFilePath, *shared, house);
+        return true;
+    }
 
+    auto warm = warmHouses.find(houseFilePath);
+    if (warm == warmHouses.end()) {
+        if (!keepHousesWarm) {
+            std::vector<std::vector<char>> parsed;
+            if (!readHouseFile(houseFilePath, parsed)) {
+                return false;
+            }
+            house = TiledHouse::fromRows(parsed);
+            return true;
+        }
+        StoredHouse storedHouse;
+        if (!loadStoredHouse(houseFilePath, storedHouse)) {
+            return false;
+        }
+        warm = warmHouses.emplace(houseFilePath, std::move(storedHouse)).first;
+    }
 
-    if (!DockingFound) {
+    const StoredHouse& stored = warm->second;
+    SharedHouseView view{stored.description.c_str(), stored.maxSteps, stored.maxBattery, stored.rows, stored.cols,
+                         stored.dockRow, stored.dockCol, stored.initialDirt, stored.cells.data()};
+    applyHouse(houseFilePath, view, house);
+    return true;
+}
 
-        std::cerr << "Error: No Docking Station Was Found in " << houseFilePath << std::endl;
+void MySimulator::applyHouse(const std::string& houseFilePath, const SharedHouseView& shared, TiledHouse& house) {
+    inputFileName = houseFilePath;
+    houseName = shared.description;
+    maxSteps = shared.maxSteps;
+    maxBattery = shared.maxBattery;
+    rows = shared.rows;
+    cols = shared.cols;
+    initialDirtLevel = shared.initialDirt;
+    dockingStation = {shared.dockRow, shared.dockCol};
+    currentPosition = dockingStation;
+
+    // The stored house is read-only and outlives the run, which reads it in place and copies only the tiles
+    // it changes the dirt of
+    house = TiledHouse::overlay(rows, cols, shared.cells);
+}
 
+bool MySimulator::loadStoredHouse(const std::string& houseFilePath, StoredHouse& storedHouse) {
+    std::vector<std::vector<char>> house;
+    if (!readHouseFile(houseFilePath, house)) {
         return false;
-
     }
 
+    storedHouse.description = houseName;
+    storedHouse.maxSteps = maxSteps;
+    storedHouse.maxBattery = maxBattery;
+    storedHouse.rows = rows;
+    storedHouse.cols = cols;
+    storedHouse.dockRow = std::get<0>(dockingStation);
+    storedHouse.dockCol = std::get<1>(dockingStation);
+    storedHouse.initialDirt = initialDirtLevel;
+    storedHouse.cells.clear();
+    storedHouse.cells.reserve(rows * cols);
+    for (const auto& row : house) {
+        storedHouse.cells.insert(storedHouse.cells.end(), row.begin(), row.end());
+    }
+    return true;
+}
 
+void MySimulator::openSharedHouses(const std::vector<std::string>& houseFiles) {
+    bool opened = sharedHouses.openOrCreate(sharedHouseSegment, houseFiles, [this](const std::string& houseFilePath, StoredHouse& storedHouse) {
+        return loadStoredHouse(houseFilePath, storedHouse);
+    });
 
-    std::cout << "Successfully read house file: " << houseFilePath << std::endl;
-
-    return true;
+    if (!opened) {
+        std::cerr << "Shared house segment unavailable, parsing house files in this process." << std::endl;
+        simulatorLogger.log(Logger::WARNING, "Could not open shared house segment " + sharedHouseSegment);
+        return;
+    }
 
+    simulatorLogger.log(Logger::INFO, std::string(sharedHouses.isCreator() ? "Created" : "Attached to") + " shared house segment " + sharedHouseSegment + " with " + std::to_string(sharedHouses.size()) + " houses");
+    std::cout << (sharedHouses.isCreator() ? "Created" : "Attached to") << " shared house segment " << sharedHouseSegment << std::endl;
 }
 
 
 
-void MySimulator::setAlgorithm(AbstractAlgorithm& algo, std::vector<std::vector<char>>& house, std::tuple<int, int>& dockingStation, 
+void MySimulator::setAlgorithm(AbstractAlgorithm& algo, const TiledHouse& house, std::tuple<int, int>& dockingStation, 
 
                                 std::unique_ptr<ConcreteWallSensor>& wallsSensor, std::unique_ptr<ConcreteDirtSensor>& dirtSensor, 
 
@@ -133,19 +250,19 @@ void MySimulator::setAlgorithm(AbstractAlgorithm& algo, std::vector<std::vector<
 
     // Ensure sensors are initialized based on the actual state of the house at the robot's initial position
 
-    bool northWall = (y == 0 || house[x][y - 1] == 'W');
+    bool northWall = (y == 0 || house.isWall(x, y - 1));
 
-    bool eastWall = (x == rows - 1 || house[x + 1][y] == 'W');
+    bool eastWall = (x == static_cast<int>(rows) - 1 || house.isWall(x + 1, y));
 
-    bool southWall = (y == cols - 1 || house[x][y + 1] == 'W');
+    bool southWall = (y == static_cast<int>(cols) - 1 || house.isWall(x, y + 1));
 
-    bool westWall = (x == 0 || house[x - 1][y] == 'W');
+    bool westWall = (x == 0 || house.isWall(x - 1, y));
 
 
 
     wallsSensor = std::make_unique<ConcreteWallSensor>(northWall, eastWall, southWall, westWall);
 
-    dirtSensor = std::make_unique<ConcreteDirtSensor>(house[x][y] - '0');
+    dirtSensor = std::make_unique<ConcreteDirtSensor>(house.at(x, y) - '0');
 
     batteryMeter = std::make_unique<ConcreteBatteryMeter>(maxBattery);
 
@@ -164,6 +281,26 @@ void MySimulator::setAlgorithm(AbstractAlgorithm& algo, std::vector<std::vector<
 
 void MySimulator::run(int argc, char** argv) {
 
+    if (argc > 1 && std::string(argv[1]) == "convert") {
+        convertHouses(argc, argv);
+        return;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "merge") {
+        mergeShards(argc, argv);
+        return;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "verify") {
+        verifyOutputs(argc, argv);
+        return;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "bounds") {
+        reportBounds(argc, argv);
+        return;
+    }
+
     std::string housePath = "./houses";
 
     std::string algoPath = "./algorithms";
@@ -188,483 +325,2568 @@ void MySimulator::run(int argc, char** argv) {
 
             numThreads = std::stoi(arg.substr(std::string("-num_threads=").length()));
 
-        } else {
-
-            std::cerr << "Unknown argument: " << arg << std::endl;
-
-            return;
-
-        }
-
-    }
-
-
+        } else if (arg.find("-shm_houses=") == 0) {
 
-    std::cout << "Starting simulation with " << numThreads << " threads." << std::endl;
+            sharedHouseSegment = arg.substr(std::string("-shm_houses=").length());
 
-    loadAndRunSimulations(housePath, algoPath, numThreads);
-
-}
+        } else if (arg == "-shm_unlink") {
 
+            unlinkSharedHouses = true;
 
+        } else if (arg.find("-param=") == 0) {
 
-void MySimulator::loadAndRunSimulations(const std::string& housePath, const std::string& algoPath, int numThreads) {
-    std::vector<std::string> houseFiles;
-    std::vector<AlgorithmHandle> algorithms;
+            std::string error;
 
-    for (const auto& entry : std::filesystem::directory_iterator(housePath)) {
-        if (entry.path().extension() == ".house") {
-            houseFiles.push_back(entry.path().string());
-            std::cout << "Loaded house file: " << entry.path().string() << std::endl;
-        }
-    }
+            if (!parameterSweep.addAxis(arg.substr(std::string("-param=").length()), error)) {
 
-    auto& registrar = AlgorithmRegistrar::getAlgorithmRegistrar();
-    std::size_t initialCount = registrar.count();
+                std::cerr << "Invalid -param: " << error << std::endl;
 
-    for (const auto& entry : std::filesystem::directory_iterator(algoPath)) {
-        if (entry.path().extension() == ".so") {
-            void* handle = dlopen(entry.path().c_str(), RTLD_LAZY);
-            if (!handle) {
-                std::cerr << "Cannot open library: " << dlerror() << std::endl;
-                continue;
-            }
-            dlerror();
+                return;
 
-            if (registrar.count() > initialCount) {
-                for (std::size_t i = initialCount; i < registrar.count(); ++i) {
-                    auto& algorithmPair = *(registrar.begin() + i);
-                    algorithms.push_back(AlgorithmHandle{algorithmPair.name(), handle, algorithmPair.create()});
-                    std::cout << "Registered algorithm: " << algorithmPair.name() << std::endl;
-                }
-                initialCount = registrar.count();
-            } else {
-                std::cerr << "No new algorithms were registered from: " << entry.path().filename().string() << std::endl;
-                dlclose(handle);
             }
-        }
-    }
-
-    if (algorithms.empty()) {
-        std::cerr << "No algorithms loaded. Exiting." << std::endl;
-        return;
-    }
-
-    std::cout << "Running simulations..." << std::endl;
-
-    runSimulations(houseFiles, algorithms, numThreads);
-
-    for (auto& algoHandle : algorithms) {
-        algoHandle.instance.reset();  // Explicitly reset the unique_ptr to delete the algorithm instance
-    }
-
-    for (auto& algoHandle : algorithms) {
-        if (algoHandle.handle != nullptr) {
-            dlclose(algoHandle.handle);  // Close the shared library
-            simulatorLogger.log(Logger::INFO, "Closed library for algorithm: " + algoHandle.name);
-        }
-    }
-
-    simulatorLogger.log(Logger::INFO, "All libraries closed. Simulation run complete.");
-}
-
-
-
-void MySimulator::runSimulations(const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms, int numThreads) {
-    std::vector<std::thread> threads;
-    std::vector<std::tuple<std::string, std::vector<std::vector<char>>, int, int>> houses;
 
-    {
-        std::lock_guard<std::mutex> guard(resultsMutex);
-        simulatorLogger.log(Logger::INFO, "Starting simulations with " + std::to_string(houseFiles.size()) + " houses and " + std::to_string(algorithms.size()) + " algorithms, using " + std::to_string(numThreads) + " threads.");
-    }
+        } else if (arg.find("-live=") == 0) {
 
-    auto& registrar = AlgorithmRegistrar::getAlgorithmRegistrar();
+            liveSocketPath = arg.substr(std::string("-live=").length());
 
-    for (const auto& houseFile : houseFiles) {
-        {
-            std::lock_guard<std::mutex> houseGuard(houseMutex);  // Lock each iteration of the external loop
-
-            simulatorLogger.log(Logger::INFO, "Processing house file: " + houseFile);
-
-            for (auto& algoHandle : const_cast<std::vector<AlgorithmHandle>&>(algorithms)) {
-                {
-                    {
-                        //std::lock_guard<std::mutex> houseGuard(resultsMutex);
-                        if (threads.size() >= numThreads) {
-                            simulatorLogger.log(Logger::INFO, "Joining threads to free up thread pool...");
-                            for (auto& thread : threads) {
-                                if (thread.joinable()) {
-                                    thread.join();
-                                }
-                            }
-                            threads.clear();
-                        }
+        } else if (arg.find("-live_filter=") == 0) {
 
-                        if (!algoHandle.instance) {
-                            simulatorLogger.log(Logger::ERROR, "Error: Algorithm instance for " + algoHandle.name + " is null!");
-                            continue;
-                        }
-                    
-                        /*std::vector<std::vector<char>> houseCopy;
-                        if (!readHouseFile(houseFile, houseCopy)) {
-                            simulatorLogger.log(Logger::ERROR, "Failed to read house file: " + houseFile);
-                            continue;
-                        }*/
-                        
-                        /*for (const auto& pair : registrar) {
-                            if (pair.name() == algoHandle.name) {
-                                algoHandle.instance = pair.create();
-                                break;
-                            }
-                        }*/
-
-                        simulatorLogger.log(Logger::INFO, "Starting thread for algorithm: " + algoHandle.name + " on house: " + houseFile);
-
-                        threads.emplace_back([houseFile, &algoHandle,registrar, this, &houses]() mutable {
-                            try {
-                                {
-                                    std::lock_guard<std::mutex> guard(resultsMutex);
-                                    std::unique_ptr<ConcreteWallSensor> wallsSensor;
-                                    std::unique_ptr<ConcreteDirtSensor> dirtSensor;
-                                    std::unique_ptr<ConcreteBatteryMeter> batteryMeter;
-                                    std::vector<std::vector<char>> houseCopy;
-                                    readHouseFile(houseFile, houseCopy);
-                                    for (const auto& pair : registrar) {
-                                        if (pair.name() == algoHandle.name) {
-                                            algoHandle.instance = pair.create();
-                                            break;
-                                        }
-                                    }
-                                    this->setAlgorithm(*algoHandle.instance, houseCopy, dockingStation, wallsSensor, dirtSensor, batteryMeter);
-                                    this->runSimulation(algoHandle.name, houseFile, houseCopy, *algoHandle.instance, wallsSensor, dirtSensor, batteryMeter);
-                                    simulatorLogger.log(Logger::INFO, "Completed simulation for algorithm: " + algoHandle.name + " on house: " + houseFile);
-                                    houses.push_back(std::make_tuple(houseFile, houseCopy, maxSteps, maxBattery));   
-                                }
-
-                            } catch (const std::exception& e) {
-                                std::lock_guard<std::mutex> guard(resultsMutex);
-                                simulatorLogger.log(Logger::ERROR, "Exception in thread for algorithm " + algoHandle.name + " on house: " + houseFile + ": " + e.what());
-                            } catch (...) {
-                                std::lock_guard<std::mutex> guard(resultsMutex);
-                                simulatorLogger.log(Logger::ERROR, "Unknown exception in thread for algorithm " + algoHandle.name + " on house: " + houseFile);
-                            }
-                        });
-                        //std::this_thread::sleep_for(std::chrono::seconds(10));
-                    }
-                }
-            }
-        }
-    }
+            liveFilter = arg.substr(std::string("-live_filter=").length());
 
-    for (auto& thread : threads) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
+        } else if (arg.find("-live_rate=") == 0) {
 
-    
-    std::vector<SimulationResult> csvResults;
+            liveRate = std::stod(arg.substr(std::string("-live_rate=").length()));
 
-    for (const auto& result : simulationResults) {
-        // No need to destructure since `result` is already of type `SimulationResult`
-        const std::string& houseName = result.houseName;
-        const std::string& algorithmName = result.algorithmName;
-        int numSteps = result.numSteps;
-        int dirtLeft = result.dirtLeft;
-        bool inDock = result.inDock;
-        const std::string& status = result.status;
-        int score = result.score;
+        } else if (arg.find("-live_wait=") == 0) {
 
-        csvResults.push_back({houseName, algorithmName, numSteps, dirtLeft, inDock, status, score});
-    }
+            liveWaitSeconds = std::stoi(arg.substr(std::string("-live_wait=").length()));
 
-    generateSummaryCSV(csvResults);
+        } else if (arg.find("-top_k=") == 0) {
 
-    std::vector<std::tuple<std::string, std::string, std::vector<std::tuple<int, int>>, std::tuple<int, int>, int>> stepsHistoryData;
+            raceTopK = std::stoul(arg.substr(std::string("-top_k=").length()));
 
-    for (const auto& result : simulationResults) {
-        // Extract information from the SimulationResult
-        const std::string& houseName = result.houseName;
-        const std::string& algorithmName = result.algorithmName;
-        std::vector<std::tuple<int, int>> stepsHistory = result.stepsHistory;
-        std::tuple<int, int> dockingStation = stepsHistory.front();
-        int score = result.score;  // Assuming 'score' is part of your SimulationResult
+        } else if (arg.find("-race_round=") == 0) {
 
-        // Add the extracted data to the new vector
-        stepsHistoryData.emplace_back(houseName, algorithmName, stepsHistory, dockingStation, score);
-    }
+            raceRoundHouses = std::stoul(arg.substr(std::string("-race_round=").length()));
 
-    writeStepsHistory("steps_history.json", stepsHistoryData);
-    writeHouseMatrix("initial_house.json", houses);
+        } else if (arg == "-numa") {
 
-    {
-        std::lock_guard<std::mutex> guard(resultsMutex); // Lock to ensure thread safety when modifying algorithms
-        for (auto& algoHandle : const_cast<std::vector<AlgorithmHandle>&>(algorithms)) {
-            algoHandle.resetInstance(); // Ensure all algorithms are reset before dlclose
+            numaPlacement = true;
 
-            if (algoHandle.handle != nullptr) {
-                dlclose(algoHandle.handle);
-                simulatorLogger.log(Logger::INFO, "Closed library for algorithm: " + algoHandle.name);
-            }
-        }
-    }
+        } else if (arg.find("-fork_at=") == 0) {
 
-    simulatorLogger.log(Logger::INFO, "All libraries closed. Simulation run complete.");
-}
+            forkStep = std::stoul(arg.substr(std::string("-fork_at=").length()));
 
+        } else if (arg == "-lockstep") {
 
+            lockstepBatches = true;
 
+        } else if (arg.find("-cooperative=") == 0) {
 
+            cooperativeRuns = std::stoul(arg.substr(std::string("-cooperative=").length()));
 
+        } else if (arg.find("-sweep_samples=") == 0) {
 
+            sweepSamples = std::stoul(arg.substr(std::string("-sweep_samples=").length()));
 
+        } else if (arg.find("-sweep_seed=") == 0) {
 
+            sweepSeed = std::stoull(arg.substr(std::string("-sweep_seed=").length()));
 
+        } else if (arg.find("-plugin_index=") == 0) {
 
+            pluginIndexPath = arg.substr(std::string("-plugin_index=").length());
 
+        } else if (arg.find("-shard=") == 0) {
 
-void MySimulator::runSimulation(const std::string& algorithmName, const std::string& houseName, 
-                                std::vector<std::vector<char>> houseCopy, AbstractAlgorithm& algo, 
-                                std::unique_ptr<ConcreteWallSensor>& wallsSensor, 
-                                std::unique_ptr<ConcreteDirtSensor>& dirtSensor, 
-                                std::unique_ptr<ConcreteBatteryMeter>& batteryMeter) {
+            std::string shard = arg.substr(std::string("-shard=").length());
 
-    // Declare variables
-    int numSteps = 0;
-    int dirtLeft = initialDirtLevel;
-    bool inDock = true;
-    std::vector<std::tuple<int, int>> stepsHistory;
-    stepsHistory.push_back(dockingStation);
-    std::string status = "WORKING";
-    std::tuple<int, int> currentPosition = dockingStation;
-    std::string logPrefix = "[" + algorithmName + "," + houseName.substr(houseName.find_last_of("/\\") + 1) + "]";
+            std::size_t slash = shard.find('/');
 
-    simulatorLogger.log(Logger::INFO, logPrefix + " Starting simulation.");
-    if(maxBattery==1){
-        status="FINISHED";
-        inDock=true;
-    }
-    while (numSteps < maxSteps && maxBattery!=1) {
+            try {
 
-        Step next = algo.nextStep();  // Call the nextStep function of the algorithm
-        simulatorLogger.log(Logger::INFO, logPrefix + " Num of Steps: " + std::to_string(numSteps));
-        simulatorLogger.log(Logger::INFO, logPrefix + " Next step: " + std::to_string(static_cast<int>(next)));
+                shardIndex = std::stoul(shard.substr(0, slash));
 
-        // Determine the new position based on the step
-        int x = std::get<0>(currentPosition);
-        int y = std::get<1>(currentPosition);
+                shardCount = slash == std::string::npos ? 0 : std::stoul(shard.substr(slash + 1));
 
-        switch (next) {
-            case Step::North: 
-                if (y > 0 && houseCopy[x][y - 1] != 'W') y -= 1; 
-                else { status = "DEAD"; break; }
-                break;
-            case Step::East: 
-                if (x < rows - 1 && houseCopy[x + 1][y] != 'W') x += 1; 
-                else { status = "DEAD"; break; }
-                break;
-            case Step::South: 
-                if (y < cols - 1 && houseCopy[x][y + 1] != 'W') y += 1; 
-                else { status = "DEAD"; break; }
-                break;
-            case Step::West: 
-                if (x > 0 && houseCopy[x - 1][y] != 'W') x -= 1; 
-                else { status = "DEAD"; break; }
-                break;
-            case Step::Finish:
-                status = "FINISHED";
-                simulatorLogger.log(Logger::INFO, logPrefix + " Algorithm reported Finish, exiting loop");
-                break;
-            case Step::Stay:
-                simulatorLogger.log(Logger::INFO, logPrefix + " Algorithm decided to Stay at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
-                break;
-        }
+            } catch (const std::exception&) {
 
-        if (status == "FINISHED" || status == "DEAD") break;
+                shardCount = 0;
 
-        currentPosition = std::make_tuple(x, y);
-        stepsHistory.push_back(currentPosition);  // Log the current position after each move
-        simulatorLogger.log(Logger::INFO, logPrefix + " Moved to position: (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+            }
 
-        // Update the wall sensor with the new surroundings
-        bool northWall = (y == 0 || houseCopy[x][y - 1] == 'W');
-        bool eastWall = (x == rows - 1 || houseCopy[x + 1][y] == 'W');
-        bool southWall = (y == cols - 1 || houseCopy[x][y + 1] == 'W');
-        bool westWall = (x == 0 || houseCopy[x - 1][y] == 'W');
-        wallsSensor->setWalls(northWall, eastWall, southWall, westWall);
+            if (shardCount == 0 || shardIndex >= shardCount) {
 
-        // Check if the robot is in the docking station
-        inDock = (currentPosition == dockingStation);
-        simulatorLogger.log(Logger::INFO, logPrefix + " In docking station: " + std::string(inDock ? "true" : "false"));
+                std::cerr << "Invalid -shard: expected i/N with 0 <= i < N" << std::endl;
 
-        // Decrease the dirt level at the current position if dirt level is between 1 and 9
-        if (houseCopy[x][y] >= '1' && houseCopy[x][y] <= '9') {
-            int dirt = houseCopy[x][y] - '0';
-            if (next == Step::Stay) {
-                dirt--;
-                dirtLeft--;  
-            }
-            houseCopy[x][y] = (dirt > 0) ? ('0' + dirt) : '0';
-            dirtSensor->setDirtLevel(dirt);
-            simulatorLogger.log(Logger::INFO, logPrefix + " Cleaned dirt at position (" + std::to_string(x) + ", " + std::to_string(y) + "), new dirt level: " + std::to_string(dirt));
-        } else {
-            dirtSensor->setDirtLevel(0);
-        }
+                return;
 
-        // Charge the battery if in the docking station and the robot stays
-        if (inDock && next == Step::Stay) {
-            int chargeAmount = std::max(1, static_cast<int>(maxBattery / 20));
-            simulatorLogger.log(Logger::INFO, logPrefix + " Charge Amount is " + std::to_string(chargeAmount));
-            batteryMeter->setBatteryState(std::min(batteryMeter->getBatteryState() + chargeAmount, maxBattery));
-            simulatorLogger.log(Logger::INFO, logPrefix + " Battery charged to " + std::to_string(batteryMeter->getBatteryState()));
-        } else {
-            if (batteryMeter->getBatteryState() > 0) {
-                batteryMeter->setBatteryState(batteryMeter->getBatteryState() - 1);
             }
-            simulatorLogger.log(Logger::INFO, logPrefix + " Battery decreased to " + std::to_string(batteryMeter->getBatteryState()));
-        }
 
-        numSteps++;
-    }
+        } else if (arg.find("-task_history=") == 0) {
 
-    // Handle the result after the loop
-    if (status == "WORKING") {
-        simulatorLogger.log(Logger::WARNING, "[" + algorithmName + "," + houseName + "] Algorithm ran out of steps");
-    }
+            taskHistoryPath = arg.substr(std::string("-task_history=").length());
 
-    int score = calculateScore(maxSteps, numSteps, dirtLeft, inDock, status);
+        } else if (arg.find("-result_cache=") == 0) {
 
-    SimulationResult result = {houseName, algorithmName, numSteps, dirtLeft, inDock, status, score,stepsHistory};
+            resultCache.setDirectory(arg.substr(std::string("-result_cache=").length()));
 
-    simulationResults.push_back(result);
-    simulatorLogger.log(Logger::INFO, "[" + algorithmName + "," + houseName + "] Recorded result for house: " + houseName + " - Score: " + std::to_string(score));
-    writeSimulationOutput(result);
-    simulatorLogger.log(Logger::INFO, "[" + algorithmName + "," + houseName + "] Finished simulation.");
-}
+        } else if (arg.find("-output_archive=") == 0) {
 
+            outputArchivePath = arg.substr(std::string("-output_archive=").length());
 
+        } else if (arg.find("-server=") == 0) {
 
+            serverSocketPath = arg.substr(std::string("-server=").length());
 
+        } else if (arg == "-watch") {
 
+            watchPlugins = true;
 
+        } else if (arg.find("-watch_interval=") == 0) {
 
+            watchIntervalMs = std::max(50, std::stoi(arg.substr(std::string("-watch_interval=").length())));
 
+        } else if (arg == "-deterministic") {
 
+            deterministicRun = true;
 
+        } else if (arg.find("-seed=") == 0) {
 
+            schedulerSeed = std::stoull(arg.substr(std::string("-seed=").length()));
 
+            seededSchedule = true;
 
-void MySimulator::generateSummaryCSV(const std::vector<SimulationResult>& results) {
+            deterministicRun = true;
 
-    std::ofstream summaryFile("summary.csv");
+        } else {
 
-    if (!summaryFile.is_open()) {
+            std::cerr << "Unknown argument: " << arg << std::endl;
 
-        std::cerr << "Failed to create summary.csv" << std::endl;
+            return;
 
-        return;
+        }
 
     }
 
 
 
-    std::set<std::string> houseNames;
-
-    std::set<std::string> algorithmNames;
-
-    for (const auto& result : results) {
-
-        houseNames.insert(result.houseName);
-
-        algorithmNames.insert(result.algorithmName);
+    parameterSweep.setSamples(sweepSamples, sweepSeed);
 
+    if (!liveSocketPath.empty() && liveFeed.start(liveSocketPath, liveRate, liveFilter)) {
+        std::cout << "Live feed on " << liveSocketPath << std::endl;
+        if (liveWaitSeconds > 0 && !liveFeed.waitForViewer(std::chrono::seconds(liveWaitSeconds))) {
+            std::cout << "No viewer connected, starting anyway." << std::endl;
+        }
     }
 
-
-
-    summaryFile << "Algorithm/House";
-
-    for (const auto& houseName : houseNames) {
-
-        summaryFile << "," << houseName;
-
+    if (!serverSocketPath.empty()) {
+        runServer(housePath, algoPath, numThreads);
+    } else {
+        std::cout << "Starting simulation with " << numThreads << " threads." << std::endl;
+        loadAndRunSimulations(housePath, algoPath, numThreads);
     }
 
-    summaryFile << "\n";
-
+    liveFeed.stop();
 
+}
 
-    for (const auto& algorithmName : algorithmNames) {
 
-        summaryFile << algorithmName;
 
-        for (const auto& houseName : houseNames) {
+// simulator convert [-out=<dir>] <house file or directory>...
+// Writes a binary <name>.houseb for every .house given, into -out (default: the current directory).
+void MySimulator::convertHouses(int argc, char** argv) {
+    std::string outDir = ".";
+    std::vector<std::string> inputs;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.find("-out=") == 0) {
+            outDir = arg.substr(std::string("-out=").length());
+        } else if (std::filesystem::is_directory(arg)) {
+            for (const auto& entry : std::filesystem::directory_iterator(arg)) {
+                if (entry.path().extension() == ".house") {
+                    inputs.push_back(entry.path().string());
+                }
+            }
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    std::sort(inputs.begin(), inputs.end());
+    if (inputs.empty()) {
+        std::cerr << "Usage: simulator convert [-out=<dir>] <house file or directory>..." << std::endl;
+        return;
+    }
 
-            auto it = std::find_if(results.begin(), results.end(), [&](const SimulationResult& result) {
+    std::error_code ec;
+    std::filesystem::create_directories(outDir, ec);
+    std::size_t converted = 0;
+    for (const auto& input : inputs) {
+        StoredHouse stored;
+        if (!loadStoredHouse(input, stored)) {
+            std::cerr << "Skipping " << input << std::endl;
+            continue;
+        }
+        std::string encoded = encodeBinaryHouse(stored);
+        std::filesystem::path output = std::filesystem::path(outDir) / std::filesystem::path(input).stem();
+        output += kBinaryHouseExtension;
+        std::ofstream outFile(output, std::ios::binary);
+        if (!outFile.write(encoded.data(), static_cast<std::streamsize>(encoded.size()))) {
+            std::cerr << "Failed to write " << output.string() << std::endl;
+            continue;
+        }
+        std::cout << "Converted " << input << " -> " << output.string() << " (" << std::filesystem::file_size(input, ec)
+                  << " -> " << encoded.size() << " bytes)" << std::endl;
+        converted++;
+    }
+    std::cout << "Converted " << converted << " of " << inputs.size() << " houses." << std::endl;
+}
 
-                return result.algorithmName == algorithmName && result.houseName == houseName;
 
-            });
 
-            if (it != results.end()) {
+// `simulator verify`: replays the Steps of recorded per-run outputs (files, directories of them, or output
+// archives) on their houses without loading any plugin, and reports every run whose recorded fields differ
+// from the replay. The house of an output is the file name up to the algorithm name, as written by
+// writeSimulationOutput, resolved against -house_path when given.
+void MySimulator::verifyOutputs(int argc, char** argv) {
+    struct Trace {
+        std::string name;
+        std::string archive; // Empty for a plain output file
+        OutputWriter::ArchiveEntry entry;
+        std::size_t house = 0;
+        bool skipped = false; // Not named like a simulator output
+        std::string problem; // Filled by the workers, empty when the run matches its replay
+    };
+
+    std::string houseDir;
+    int numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<Trace> traces;
+    auto addFile = [&](const std::string& file) {
+        std::vector<OutputWriter::ArchiveEntry> entries;
+        if (OutputWriter::readArchiveIndex(file, entries)) {
+            for (auto& entry : entries) {
+                traces.push_back({entry.name, file, entry, 0, false, ""});
+            }
+        } else {
+            traces.push_back({file, "", {}, 0, false, ""});
+        }
+    };
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.find("-house_path=") == 0) {
+            houseDir = arg.substr(std::string("-house_path=").length());
+        } else if (arg.find("-num_threads=") == 0) {
+            numThreads = std::max(1, std::stoi(arg.substr(std::string("-num_threads=").length())));
+        } else if (std::filesystem::is_directory(arg)) {
+            std::vector<std::string> files;
+            for (const auto& entry : std::filesystem::directory_iterator(arg)) {
+                if (entry.path().extension() == ".txt") {
+                    files.push_back(entry.path().string());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            for (const auto& file : files) {
+                addFile(file);
+            }
+        } else {
+            addFile(arg);
+        }
+    }
+    if (traces.empty()) {
+        std::cerr << "Usage: simulator verify [-house_path=<dir>] [-num_threads=<N>] <output file, directory or archive>..." << std::endl;
+        return;
+    }
 
-                summaryFile << "," << it->score;
+    // Houses are parsed once, up front, on this thread; the workers only read them
+    std::vector<StoredHouse> houses;
+    std::vector<bool> houseLoaded;
+    std::map<std::string, std::size_t> houseIndex;
+    std::size_t skipped = 0;
+    for (auto& trace : traces) {
+        std::size_t cut = std::string::npos;
+        for (const char* extension : {".house-", ".houseb-"}) {
+            std::size_t found = trace.name.rfind(extension);
+            if (found != std::string::npos && (cut == std::string::npos || found > cut)) {
+                cut = found + std::string(extension).size() - 1;
+            }
+        }
+        if (cut == std::string::npos) {
+            trace.skipped = true;
+            skipped++;
+            continue;
+        }
+        std::string houseFile = trace.name.substr(0, cut);
+        if (!houseDir.empty()) {
+            houseFile = (std::filesystem::path(houseDir) / std::filesystem::path(houseFile).filename()).string();
+        }
+        auto [it, inserted] = houseIndex.emplace(houseFile, houses.size());
+        if (inserted) {
+            houses.emplace_back();
+            houseLoaded.push_back(loadStoredHouse(houseFile, houses.back()));
+        }
+        trace.house = it->second;
+        if (!houseLoaded[trace.house]) {
+            trace.problem = "cannot read house " + houseFile;
+        }
+    }
 
+    std::atomic<std::size_t> nextTrace{0};
+    auto worker = [&]() {
+        std::string text;
+        for (std::size_t t = nextTrace++; t < traces.size(); t = nextTrace++) {
+            Trace& trace = traces[t];
+            if (trace.skipped || !trace.problem.empty()) {
+                continue;
+            }
+            bool read = false;
+            if (trace.archive.empty()) {
+                std::ifstream file(trace.name, std::ios::binary);
+                text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                read = file.good() || file.eof();
             } else {
-
-                summaryFile << ",N/A";
-
+                read = OutputWriter::readArchiveEntry(trace.archive, trace.entry, text);
+            }
+            RecordedRun recorded;
+            if (!read || !parseRecordedRun(text, recorded)) {
+                trace.problem = "cannot parse the output";
+                continue;
             }
 
+            ReplayOutcome replay = replaySteps(houses[trace.house], recorded.steps);
+            if (!replay.error.empty()) {
+                trace.problem = "invalid steps: " + replay.error;
+                continue;
+            }
+            std::string differences;
+            auto compare = [&](const char* field, const std::string& recordedValue, const std::string& replayedValue) {
+                if (recordedValue != replayedValue) {
+                    differences += std::string(differences.empty() ? "" : ", ") + field + " " + recordedValue + " (replay " + replayedValue + ")";
+                }
+            };
+            compare("NumSteps", std::to_string(recorded.numSteps), std::to_string(replay.numSteps));
+            compare("DirtLeft", std::to_string(recorded.dirtLeft), std::to_string(replay.dirtLeft));
+            compare("Status", recorded.status, statusName(replay.status));
+            compare("InDock", recorded.inDock ? "TRUE" : "FALSE", replay.inDock ? "TRUE" : "FALSE");
+            compare("Score", std::to_string(recorded.score), std::to_string(replay.score));
+            trace.problem = differences;
         }
-
-        summaryFile << "\n";
-
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < std::min<std::size_t>(numThreads, traces.size()); ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
     }
 
+    std::size_t mismatched = 0;
+    for (const auto& trace : traces) {
+        if (!trace.skipped && !trace.problem.empty()) {
+            std::cout << trace.name << (trace.archive.empty() ? "" : " in " + trace.archive) << ": " << trace.problem << std::endl;
+            mismatched++;
+        }
+    }
+    std::cout << "Verified " << traces.size() - skipped << " runs: " << traces.size() - skipped - mismatched << " match, "
+              << mismatched << " do not" << (skipped ? " (" + std::to_string(skipped) + " other files skipped)" : "") << "." << std::endl;
+}
 
+// `simulator bounds [-house_path=<dir>] [-num_threads=<N>] [-summary=<file>]`: computes the HouseBound of every
+// house of a summary.csv (the one in the current directory by default), in parallel, and writes efficiency.csv:
+// the summary with every score replaced by the house's score bound divided by that score, 1 being the best the
+// rules allow, and a Mean column. Without a summary it reports the bounds of the houses in -house_path.
+void MySimulator::reportBounds(int argc, char** argv) {
+    std::string houseDir;
+    std::string summaryPath = "summary.csv";
+    int numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.find("-house_path=") == 0) {
+            houseDir = arg.substr(std::string("-house_path=").length());
+        } else if (arg.find("-num_threads=") == 0) {
+            numThreads = std::max(1, std::stoi(arg.substr(std::string("-num_threads=").length())));
+        } else if (arg.find("-summary=") == 0) {
+            summaryPath = arg.substr(std::string("-summary=").length());
+        } else {
+            std::cerr << "Usage: simulator bounds [-house_path=<dir>] [-num_threads=<N>] [-summary=<file>]" << std::endl;
+            return;
+        }
+    }
+
+    auto splitLine = [](const std::string& line) {
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(field);
+        }
+        return fields;
+    };
+
+    // The houses are the columns of the summary after the algorithm (and parameters) columns
+    std::vector<std::string> header;
+    std::vector<std::vector<std::string>> rows;
+    std::size_t firstHouse = 1;
+    std::ifstream summary(summaryPath);
+    if (summary) {
+        std::string line;
+        if (std::getline(summary, line)) {
+            header = splitLine(line);
+        }
+        firstHouse = header.size() > 1 && header[1] == "Parameters" ? 2 : 1;
+        while (std::getline(summary, line)) {
+            if (!line.empty()) {
+                rows.push_back(splitLine(line));
+            }
+        }
+    } else if (!houseDir.empty()) {
+        header.push_back("Algorithm/House");
+        std::vector<std::string> listed;
+        for (const auto& entry : std::filesystem::directory_iterator(houseDir)) {
+            if (isHouseFile(entry.path())) {
+                listed.push_back(entry.path().string());
+            }
+        }
+        std::sort(listed.begin(), listed.end());
+        header.insert(header.end(), listed.begin(), listed.end());
+    }
+    if (header.size() <= firstHouse) {
+        std::cerr << "No houses: " << summaryPath << " cannot be read and no -house_path was given." << std::endl;
+        return;
+    }
+
+    // Houses are parsed up front on this thread, the bounds are computed by the workers
+    std::size_t houseCount = header.size() - firstHouse;
+    std::vector<StoredHouse> houses(houseCount);
+    std::vector<bool> loaded(houseCount);
+    std::vector<std::string> houseFiles(houseCount);
+    for (std::size_t h = 0; h < houseCount; ++h) {
+        std::string& houseFile = houseFiles[h];
+        houseFile = header[firstHouse + h];
+        if (!houseDir.empty()) {
+            houseFile = (std::filesystem::path(houseDir) / std::filesystem::path(houseFile).filename()).string();
+        }
+        loaded[h] = loadStoredHouse(houseFile, houses[h]);
+        if (!loaded[h]) {
+            std::cerr << "Cannot read house " << houseFile << std::endl;
+        }
+    }
+
+    std::vector<HouseBound> bounds(houseCount);
+    std::atomic<std::size_t> nextHouse{0};
+    auto worker = [&]() {
+        for (std::size_t h = nextHouse++; h < houseCount; h = nextHouse++) {
+            if (loaded[h]) {
+                bounds[h] = computeHouseBound(houses[h]);
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < std::min<std::size_t>(numThreads, houseCount); ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::cout << "House,InitialDirt,ReachableDirt,CleanableDirt,MinSteps,ScoreBound" << std::endl;
+    for (std::size_t h = 0; h < houseCount; ++h) {
+        if (loaded[h]) {
+            const HouseBound& bound = bounds[h];
+            std::cout << header[firstHouse + h] << ',' << bound.initialDirt << ',' << bound.reachableDirt << ','
+                      << bound.cleanableDirt << ',' << bound.minSteps << ',' << bound.scoreBound << std::endl;
+        }
+    }
+    if (rows.empty()) {
+        return;
+    }
+
+    // Two rows per configuration. StepEfficiency is the house's minSteps over the NumSteps of the run's output file,
+    // for runs that finished in the dock with all cleanable dirt cleaned (minSteps is the bound for exactly that, a
+    // run leaving dirt behind could be faster); ScoreEfficiency is the score bound over the score. A score of 0 only
+    // happens on a house without dirt, where 0 is also the bound.
+    std::ofstream efficiency("efficiency.csv");
+    if (!efficiency) {
+        std::cerr << "Failed to create efficiency.csv" << std::endl;
+        return;
+    }
+    efficiency << std::fixed << std::setprecision(3);
+    for (std::size_t i = 0; i < header.size(); ++i) {
+        efficiency << (i ? "," : "") << header[i];
+        if (i + 1 == firstHouse) {
+            efficiency << ",Measure";
+        }
+    }
+    efficiency << ",Mean\n";
+
+    std::vector<std::string> meanLines;
+    for (const auto& row : rows) {
+        std::string name = row.empty() ? "" : row[0];
+        std::string parameters = firstHouse == 2 && row.size() > 1 ? row[1] : "";
+        std::vector<std::string> stepCells(houseCount, "N/A");
+        std::vector<std::string> scoreCells(houseCount, "N/A");
+        double stepTotal = 0;
+        double scoreTotal = 0;
+        std::size_t stepCount = 0;
+        std::size_t scoreCount = 0;
+        auto format = [](double ratio) {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(3) << ratio;
+            return text.str();
+        };
+        for (std::size_t h = 0; h < houseCount && firstHouse + h < row.size(); ++h) {
+            if (!loaded[h]) {
+                continue;
+            }
+            try {
+                long long score = std::stoll(row[firstHouse + h]);
+                double ratio = score > 0 ? static_cast<double>(bounds[h].scoreBound) / static_cast<double>(score) : 1.0;
+                scoreCells[h] = format(ratio);
+                scoreTotal += ratio;
+                scoreCount++;
+            } catch (const std::exception&) {
+                continue;  // N/A, a configuration dropped by racing
+            }
+
+            std::ifstream output(outputFileName(houseFiles[h], name, parameters));
+            RecordedRun run;
+            std::string text((std::istreambuf_iterator<char>(output)), std::istreambuf_iterator<char>());
+            if (output && parseRecordedRun(text, run) && run.status == "FINISHED" && run.inDock &&
+                run.dirtLeft <= bounds[h].initialDirt - bounds[h].cleanableDirt) {
+                double ratio = run.numSteps > 0 ? static_cast<double>(bounds[h].minSteps) / static_cast<double>(run.numSteps) : 1.0;
+                stepCells[h] = format(ratio);
+                stepTotal += ratio;
+                stepCount++;
+            }
+        }
+
+        auto writeRow = [&](const char* measure, const std::vector<std::string>& cells, double total, std::size_t count) {
+            for (std::size_t i = 0; i < firstHouse && i < row.size(); ++i) {
+                efficiency << (i ? "," : "") << row[i];
+            }
+            efficiency << ',' << measure;
+            for (const auto& cell : cells) {
+                efficiency << ',' << cell;
+            }
+            efficiency << ',' << (count ? format(total / static_cast<double>(count)) : std::string("N/A")) << "\n";
+        };
+        writeRow("StepEfficiency", stepCells, stepTotal, stepCount);
+        writeRow("ScoreEfficiency", scoreCells, scoreTotal, scoreCount);
+
+        std::string line = "  " + name + (parameters.empty() ? "" : " [" + parameters + "]") + ": steps " +
+                           (stepCount ? format(stepTotal / static_cast<double>(stepCount)) : std::string("N/A")) + " over " +
+                           std::to_string(stepCount) +  " complete runs, score " +
+                           (scoreCount ? format(scoreTotal / static_cast<double>(scoreCount)) : std::string("N/A")) + " over " +
+                           std::to_string(scoreCount) + " houses";
+        meanLines.push_back(line);
+    }
+    std::cout << std::endl << "Mean efficiency (minSteps / NumSteps and score bound / score, 1 is optimal):" << std::endl;
+    for (const auto& line : meanLines) {
+        std::cout << line << std::endl;
+    }
+    std::cout << "Efficiency written to efficiency.csv" << std::endl;
+}
+
+// Plugin discovery: every library is validated once by opening it with RTLD_NOW, so unresolved symbols
+// fail here and not in the middle of a simulation, and checking its ABI version and registrations.
+// The outcome is kept in the plugin index; unchanged libraries are then opened without being hashed or
+// probed again, and libraries that failed validation are skipped without being opened at all.
+void MySimulator::loadAlgorithms(const std::string& algoPath, std::vector<AlgorithmHandle>& algorithms) {
+    PluginIndex index(pluginIndexPath.empty() ? (std::filesystem::path(algoPath) / ".plugin_index").string() : pluginIndexPath);
+    index.load();
+
+    std::vector<std::string> libraries;
+    for (const auto& entry : std::filesystem::directory_iterator(algoPath)) {
+        if (entry.path().extension() == ".so") {
+            libraries.push_back(entry.path().string());
+        }
+    }
+    std::sort(libraries.begin(), libraries.end());
+
+    for (const auto& library : libraries) {
+        loadLibrary(library, index, algorithms);
+    }
+
+    index.prune();
+    if (!index.save()) {
+        simulatorLogger.log(Logger::WARNING, "Could not write plugin index " + index.path());
+    }
+}
+
+bool MySimulator::loadLibrary(const std::string& library, PluginIndex& index, std::vector<AlgorithmHandle>& algorithms) {
+    auto& registrar = AlgorithmRegistrar::getAlgorithmRegistrar();
+
+    auto cleanError = [](std::string error) {
+        std::replace(error.begin(), error.end(), '\t', ' ');
+        std::replace(error.begin(), error.end(), '\n', ' ');
+        return error;
+    };
+
+    std::string fileName = std::filesystem::path(library).filename().string();
+    const PluginIndex::Entry* cached = index.lookup(library);
+    if (cached && !cached->valid) {
+        std::cerr << "Skipping plugin that failed validation: " << fileName << " (" << cached->error << ")" << std::endl;
+        return false;
+    }
+
+    PluginIndex::Entry entry;
+    if (cached) {
+        entry = *cached;
+    } else if (!PluginIndex::describe(library, entry)) {
+        std::cerr << "Cannot read library: " << library << std::endl;
+        return false;
+    }
+
+    // With hot reload the library is opened from a private copy: the original may then be overwritten
+    // while loaded, and a reload always maps a fresh image even if the old one could not be unloaded
+    std::string openPath = library;
+    if (privatePluginCopies) {
+        openPath = (std::filesystem::path(pluginCopyDir) / (std::to_string(++pluginGeneration) + "-" + fileName)).string();
+        std::error_code ec;
+        std::filesystem::copy_file(library, openPath, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) {
+            std::cerr << "Cannot copy library " << library << ": " << ec.message() << std::endl;
+            return false;
+        }
+    }
+
+    std::size_t before = registrar.count();
+    void* handle = dlopen(openPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (privatePluginCopies) {
+        std::filesystem::remove(openPath);  // The mapping stays valid
+    }
+    if (!handle) {
+        entry.valid = false;
+        entry.error = cleanError(dlerror());
+        if (std::size_t at = entry.error.find(openPath); privatePluginCopies && at != std::string::npos) {
+            entry.error.replace(at, openPath.size(), library);
+        }
+        std::cerr << "Cannot open library: " << entry.error << std::endl;
+        index.update(library, entry);
+        return false;
+    }
+
+    if (!cached) {
+        auto abiVersion = reinterpret_cast<int (*)()>(dlsym(handle, "algorithm_abi_version"));
+        dlerror();
+        entry.abiVersion = abiVersion ? abiVersion() : 0;  // 0: built before plugins reported a version
+        entry.valid = true;
+        entry.error.clear();
+        if (entry.abiVersion != 0 && entry.abiVersion != ALGORITHM_ABI_VERSION) {
+            entry.valid = false;
+            entry.error = "ABI version " + std::to_string(entry.abiVersion) + ", expected " + std::to_string(ALGORITHM_ABI_VERSION);
+        } else if (registrar.count() == before) {
+            entry.valid = false;
+            entry.error = "no algorithms registered";
+        }
+    }
+
+    if (!entry.valid || registrar.count() == before) {
+        std::cerr << "Rejected plugin " << fileName << ": " << (entry.error.empty() ? "no algorithms registered" : entry.error) << std::endl;
+        registrar.eraseFrom(before);  // The factories live in the library, drop them before closing it
+        dlclose(handle);
+        entry.valid = false;
+        index.update(library, entry);
+        return false;
+    }
+
+    std::vector<std::string> names;
+    for (std::size_t i = before; i < registrar.count(); ++i) {
+        auto& algorithmPair = *(registrar.begin() + i);
+        names.push_back(algorithmPair.name());
+        algorithms.push_back(AlgorithmHandle{algorithmPair.name(), library, handle, algorithmPair.create()});
+        algorithms.back().libraryHash = entry.hash;
+        algorithms.back().parameterized = dynamic_cast<ParameterizedAlgorithm*>(algorithms.back().instance.get()) != nullptr;
+        algorithms.back().snapshots = dynamic_cast<SnapshotAlgorithm*>(algorithms.back().instance.get()) != nullptr;
+        std::cout << "Registered algorithm: " << algorithmPair.name() << (cached ? " (cached)" : "") << std::endl;
+    }
+    if (!cached || names != entry.algorithmNames) {
+        entry.algorithmNames = names;
+        index.update(library, entry);
+    }
+    return true;
+}
+
+void MySimulator::unloadAlgorithms(std::vector<AlgorithmHandle>& algorithms) {
+    std::lock_guard<std::mutex> guard(resultsMutex);
+
+    // Instances and factories are code from the libraries, they have to go before dlclose
+    for (auto& algoHandle : algorithms) {
+        algoHandle.resetInstance();
+    }
+
+    std::set<void*> closed;
+    for (auto& algoHandle : algorithms) {
+        if (algoHandle.handle != nullptr && closed.insert(algoHandle.handle).second) {
+            dlclose(algoHandle.handle);
+            simulatorLogger.log(Logger::INFO, "Closed library for algorithm: " + algoHandle.name);
+        }
+        algoHandle.handle = nullptr;
+    }
+
+    simulatorLogger.log(Logger::INFO, "All libraries closed. Simulation run complete.");
+}
+
+PluginGate& MySimulator::pluginGate(const std::string& library) {
+    std::lock_guard<std::mutex> guard(pluginGatesMutex);
+    auto& gate = pluginGates[library];
+    if (!gate) {
+        gate = std::make_unique<PluginGate>();
+    }
+    return *gate;
+}
+
+// Swaps one library while the daemon keeps serving: evaluations already running on it finish first,
+// new ones wait at the gate until the new version is loaded (or find the algorithm gone if it was removed).
+void MySimulator::reloadLibrary(const std::string& library, bool stillPresent, PluginIndex& index, std::vector<AlgorithmHandle>& algorithms) {
+    PluginGate& gate = pluginGate(library);
+    gate.drain();
+    {
+        std::unique_lock<std::shared_mutex> algorithmsLock(algorithmsMutex);
+        std::lock_guard<std::mutex> guard(resultsMutex);
+
+        void* oldHandle = nullptr;
+        auto& registrar = AlgorithmRegistrar::getAlgorithmRegistrar();
+        for (auto it = algorithms.begin(); it != algorithms.end();) {
+            if (it->libraryPath != library) {
+                ++it;
+                continue;
+            }
+            it->instance.reset();
+            registrar.unregisterAlgorithm(it->name);
+            oldHandle = it->handle;
+            std::cout << "Unregistered algorithm: " << it->name << std::endl;
+            it = algorithms.erase(it);
+        }
+        if (oldHandle) {
+            dlclose(oldHandle);
+            simulatorLogger.log(Logger::INFO, "Closed library " + library);
+        }
+
+        if (stillPresent && loadLibrary(library, index, algorithms)) {
+            simulatorLogger.log(Logger::INFO, "Loaded library " + library);
+        }
+        index.prune();
+        if (!index.save()) {
+            simulatorLogger.log(Logger::WARNING, "Could not write plugin index " + index.path());
+        }
+    }
+    gate.resume();
+}
+
+
+
+namespace {
+
+std::atomic<SimulatorServer*> activeServer{nullptr};
+
+void stopActiveServer(int) {
+    if (SimulatorServer* server = activeServer.load()) {
+        server->stop();
+    }
+}
+
+}  // namespace
+
+// Daemon mode: houses and plugins are loaded once and kept warm, evaluations are requested over a
+// Unix domain socket, one request per line:
+//   LIST                                   -> ALGORITHM <name> / HOUSE <file> lines, then OK
+//   EVAL <algorithm> [house...] [name=value...] -> one RESULT line per house as it finishes, then DONE <count>
+//   PING -> PONG, QUIT -> BYE (closes the connection), SHUTDOWN -> BYE (stops the daemon)
+// Houses are given as listed by LIST, by file name, or as a path to a house file not loaded yet.
+void MySimulator::runServer(const std::string& housePath, const std::string& algoPath, int numThreads) {
+    std::vector<std::string> houseFiles;
+    for (const auto& entry : std::filesystem::directory_iterator(housePath)) {
+        if (isHouseFile(entry.path())) {
+            houseFiles.push_back(entry.path().string());
+        }
+    }
+    std::sort(houseFiles.begin(), houseFiles.end());
+
+    if (!sharedHouseSegment.empty()) {
+        openSharedHouses(houseFiles);
+    }
+
+    keepHousesWarm = true;
+    for (const auto& houseFile : houseFiles) {
+        TiledHouse house;
+        std::lock_guard<std::mutex> guard(resultsMutex);
+        loadHouse(houseFile, house);
+    }
+
+    if (watchPlugins) {
+        char copyDir[] = "/tmp/simulator-plugins-XXXXXX";
+        if (mkdtemp(copyDir)) {
+            pluginCopyDir = copyDir;
+            privatePluginCopies = true;
+        } else {
+            std::cerr << "Cannot create a directory for plugin copies, -watch is disabled" << std::endl;
+            watchPlugins = false;
+        }
+    }
+
+    std::vector<AlgorithmHandle> algorithms;
+    loadAlgorithms(algoPath, algorithms);
+
+    SimulatorServer server;
+    if (!server.listen(serverSocketPath)) {
+        unloadAlgorithms(algorithms);
+        if (privatePluginCopies) {
+            std::filesystem::remove_all(pluginCopyDir);
+        }
+        return;
+    }
+
+    PluginIndex pluginIndex(pluginIndexPath.empty() ? (std::filesystem::path(algoPath) / ".plugin_index").string() : pluginIndexPath);
+    PluginWatcher watcher;
+    if (watchPlugins) {
+        pluginIndex.load();
+        watcher.start(algoPath, watchIntervalMs, [&](const std::string& library, PluginWatcher::Change change) {
+            const char* what = change == PluginWatcher::Change::Added ? "added" :
+                               change == PluginWatcher::Change::Modified ? "changed" : "removed";
+            std::cout << "Plugin " << what << ": " << library << std::endl;
+            simulatorLogger.log(Logger::INFO, std::string("Plugin ") + what + ": " + library);
+            reloadLibrary(library, change != PluginWatcher::Change::Removed, pluginIndex, algorithms);
+        });
+    }
+
+    activeServer = &server;
+    std::signal(SIGINT, stopActiveServer);
+    std::signal(SIGTERM, stopActiveServer);
+
+    std::cout << "Serving " << houseFiles.size() << " houses and " << algorithms.size() << " algorithms on " << serverSocketPath << std::endl;
+    simulatorLogger.log(Logger::INFO, "Server listening on " + serverSocketPath);
+
+    server.serve([&](const std::string& request, const SimulatorServer::Reply& reply) {
+        return handleServerRequest(request, reply, server, houseFiles, algorithms, numThreads);
+    });
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    activeServer = nullptr;
+    watcher.stop();
+
+    simulatorLogger.log(Logger::INFO, "Server on " + serverSocketPath + " stopped");
+    unloadAlgorithms(algorithms);
+    if (privatePluginCopies) {
+        std::filesystem::remove_all(pluginCopyDir);
+    }
+}
+
+bool MySimulator::handleServerRequest(const std::string& request, const SimulatorServer::Reply& reply, SimulatorServer& server,
+                                      const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms, int numThreads) {
+    std::stringstream stream(request);
+    std::string command;
+    stream >> command;
+
+    if (command == "PING") {
+        return reply("PONG");
+    }
+    if (command == "QUIT") {
+        reply("BYE");
+        return false;
+    }
+    if (command == "SHUTDOWN") {
+        reply("BYE");
+        server.stop();
+        return false;
+    }
+    if (command == "LIST") {
+        std::shared_lock<std::shared_mutex> algorithmsLock(algorithmsMutex);
+        for (const auto& algoHandle : algorithms) {
+            reply("ALGORITHM " + algoHandle.name);
+        }
+        for (const auto& houseFile : houseFiles) {
+            reply("HOUSE " + houseFile);
+        }
+        return reply("OK");
+    }
+    if (command != "EVAL") {
+        return reply("ERROR unknown command " + command);
+    }
+
+    std::string algorithmName;
+    stream >> algorithmName;
+    // Tasks only need the name, library and whether it takes parameters; a copy stays valid across reloads
+    AlgorithmHandle algoHandle{algorithmName, "", nullptr, nullptr};
+    auto findAlgorithm = [&]() {
+        std::shared_lock<std::shared_mutex> algorithmsLock(algorithmsMutex);
+        for (const auto& handle : algorithms) {
+            if (handle.name == algorithmName) {
+                algoHandle.libraryPath = handle.libraryPath;
+                algoHandle.parameterized = handle.parameterized;
+                algoHandle.snapshots = handle.snapshots;
+                return true;
+            }
+        }
+        return false;
+    };
+    if (!findAlgorithm()) {
+        return reply("ERROR unknown algorithm " + algorithmName);
+    }
+
+    std::vector<std::string> requestedHouses;
+    ParameterSet parameters;
+    std::string token;
+    while (stream >> token) {
+        std::size_t equals = token.find('=');
+        if (equals != std::string::npos) {
+            try {
+                parameters.emplace_back(token.substr(0, equals), std::stod(token.substr(equals + 1)));
+            } catch (const std::exception&) {
+                return reply("ERROR invalid parameter " + token);
+            }
+            continue;
+        }
+
+        auto known = std::find_if(houseFiles.begin(), houseFiles.end(), [&](const std::string& houseFile) {
+            return houseFile == token || std::filesystem::path(houseFile).filename() == token;
+        });
+        if (known != houseFiles.end()) {
+            requestedHouses.push_back(*known);
+        } else if (std::filesystem::exists(token)) {
+            requestedHouses.push_back(token);
+        } else {
+            return reply("ERROR unknown house " + token);
+        }
+    }
+    if (requestedHouses.empty()) {
+        requestedHouses = houseFiles;
+    }
+
+    // Hold the library for the whole request; if it was reloaded while we waited, look the algorithm up again
+    std::string library = algoHandle.libraryPath;
+    PluginUse use(pluginGate(library));
+    if (!findAlgorithm() || algoHandle.libraryPath != library) {
+        return reply("ERROR algorithm " + algorithmName + " was unloaded");
+    }
+
+    // Results are streamed back in completion order
+    std::atomic<std::size_t> nextHouse{0};
+    std::atomic<std::size_t> completed{0};
+    auto worker = [&]() {
+        for (std::size_t i = nextHouse++; i < requestedHouses.size(); i = nextHouse++) {
+            SimulationResult result;
+            bool ok = false;
+            try {
+                ok = runTask(requestedHouses[i], algoHandle, parameters, result, nullptr);
+            } catch (const std::exception& e) {
+                reply("ERROR " + requestedHouses[i] + " " + e.what());
+                continue;
+            }
+            if (!ok) {
+                reply("ERROR failed to run " + requestedHouses[i]);
+                continue;
+            }
+            completed++;
+            reply("RESULT " + result.houseName + " " + result.algorithmName +
+                  " NumSteps=" + std::to_string(result.numSteps) + " DirtLeft=" + std::to_string(result.dirtLeft) +
+                  " Status=" + statusName(result.status) + " InDock=" + (result.inDock ? "TRUE" : "FALSE") +
+                  " Score=" + std::to_string(result.score) +
+                  (result.parameters.empty() ? "" : " Parameters=" + result.parameters));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    std::size_t workerCount = std::min<std::size_t>(std::max(numThreads, 1), requestedHouses.size());
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return reply("DONE " + std::to_string(completed.load()));
+}
+
+
+
+void MySimulator::loadAndRunSimulations(const std::string& housePath, const std::string& algoPath, int numThreads) {
+    std::vector<std::string> houseFiles;
+    std::vector<AlgorithmHandle> algorithms;
+
+    for (const auto& entry : std::filesystem::directory_iterator(housePath)) {
+        if (isHouseFile(entry.path())) {
+            houseFiles.push_back(entry.path().string());
+            std::cout << "Loaded house file: " << entry.path().string() << std::endl;
+        }
+    }
+
+    if (deterministicRun || shardCount > 1) {
+        // directory_iterator order is unspecified, so pin it down; every shard must see the same task space
+        std::sort(houseFiles.begin(), houseFiles.end());
+    }
+
+    if (!sharedHouseSegment.empty()) {
+        openSharedHouses(houseFiles);
+    }
+
+    loadAlgorithms(algoPath, algorithms);
+
+    if (algorithms.empty()) {
+        std::cerr << "No algorithms loaded. Exiting." << std::endl;
+        return;
+    }
+
+    if (deterministicRun || shardCount > 1) {
+        std::stable_sort(algorithms.begin(), algorithms.end(), [](const AlgorithmHandle& a, const AlgorithmHandle& b) {
+            return a.name < b.name;
+        });
+    }
+
+    std::cout << "Running simulations..." << std::endl;
+
+    runSimulations(houseFiles, algorithms, numThreads);
+
+    if (deterministicRun) {
+        writeRunManifest("run_manifest.json", housePath, algoPath, numThreads, houseFiles, algorithms);
+    }
+
+    if (unlinkSharedHouses && sharedHouses.isOpen()) {
+        sharedHouses.unlink();
+        simulatorLogger.log(Logger::INFO, "Unlinked shared house segment " + sharedHouseSegment);
+    }
+
+    unloadAlgorithms(algorithms);
+}
+
+
+
+// Tasks go out longest first by their estimated cost, ties in input order house by house; with -seed the
+// dispatch order is a seeded permutation of the input order instead. Either way every result lands in its
+// own slot, so the outputs do not depend on the order. A variant is an (algorithm, sweep configuration) pair.
+// With -shard=i/N only the tasks of shard i are kept: house h and variant v belong to shard (h + v) % N, which
+// spreads the houses of every variant and the variants of every house evenly over the shards.
+std::vector<MySimulator::SimulationTask> MySimulator::scheduleTasks(std::size_t houseCount, const std::vector<std::pair<std::size_t, std::size_t>>& variants,
+                                                                    const std::vector<double>& taskCosts) const {
+    std::vector<SimulationTask> tasks;
+    tasks.reserve(houseCount * variants.size());
+    std::vector<double> costs;
+    for (std::size_t h = 0; h < houseCount; ++h) {
+        for (std::size_t v = 0; v < variants.size(); ++v) {
+            if (shardCount > 1 && (h + v) % shardCount != shardIndex) {
+                continue;
+            }
+            tasks.push_back({h, variants[v].first, variants[v].second});
+            if (taskCosts.size() == houseCount * variants.size()) {
+                costs.push_back(taskCosts[h * variants.size() + v]);
+            }
+        }
+    }
+
+    if (seededSchedule) {
+        // Hand-rolled Fisher-Yates: std::shuffle's output is implementation-defined, mt19937_64's is not
+        std::mt19937_64 rng(schedulerSeed);
+        for (std::size_t i = tasks.size(); i > 1; --i) {
+            std::swap(tasks[i - 1], tasks[rng() % i]);
+        }
+    } else if (costs.size() == tasks.size()) {
+        // Longest first, so the big runs do not start last and set the makespan; the cost of a task is at
+        // the position it was created at, and ties keep that order
+        std::vector<std::size_t> order(tasks.size());
+        for (std::size_t t = 0; t < order.size(); ++t) {
+            order[t] = t;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return costs[a] > costs[b]; });
+        std::vector<SimulationTask> sorted;
+        sorted.reserve(tasks.size());
+        for (std::size_t t : order) {
+            sorted.push_back(tasks[t]);
+        }
+        tasks = std::move(sorted);
+    }
+    return tasks;
+}
+
+// The header of a house and a hash of the whole file, without parsing the cells
+bool MySimulator::readHouseShape(const std::string& houseFilePath, HouseShape& shape) {
+    std::ifstream file(houseFilePath, std::ios::binary);
+    if (!file || !hashFile(houseFilePath, shape.hash)) {
+        return false;
+    }
+    std::string head(4096, '\0');
+    file.read(head.data(), static_cast<std::streamsize>(head.size()));
+    head.resize(static_cast<std::size_t>(file.gcount()));
+
+    if (isBinaryHouse(head.data(), head.size())) {
+        StoredHouse header;
+        if (!decodeBinaryHouseHeader(head.data(), head.size(), header)) {
+            return false;
+        }
+        shape.rows = header.rows;
+        shape.cols = header.cols;
+        shape.maxSteps = header.maxSteps;
+        shape.maxBattery = header.maxBattery;
+        return true;
+    }
+
+    // Lines 2 to 5 are MaxSteps, MaxBattery, Rows and Cols, as in readHouseFile
+    std::stringstream lines(head);
+    std::string line;
+    std::getline(lines, line);
+    for (std::size_t* value : {&shape.maxSteps, &shape.maxBattery, &shape.rows, &shape.cols}) {
+        if (!std::getline(lines, line)) {
+            return false;
+        }
+        std::stringstream(line.substr(line.find('=') + 1)) >> *value;
+    }
+    return true;
+}
+
+void MySimulator::writeRunManifest(const std::string& filename, const std::string& housePath, const std::string& algoPath, int numThreads,
+                                   const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms) {
+    std::ofstream outFile(filename);
+    if (!outFile.is_open()) {
+        std::cerr << "Failed to create " << filename << std::endl;
+        return;
+    }
+
+    auto fileHash = [](const std::string& path) {
+        std::uint64_t hash = 0;
+        return hashFile(path, hash) ? hashToHex(hash) : std::string("unreadable");
+    };
+
+    outFile << "{\n";
+    outFile << "  \"housePath\": \"" << housePath << "\",\n";
+    outFile << "  \"algoPath\": \"" << algoPath << "\",\n";
+    outFile << "  \"numThreads\": " << numThreads << ",\n";
+    outFile << "  \"seed\": " << (seededSchedule ? std::to_string(schedulerSeed) : "null") << ",\n";
+    outFile << "  \"tasks\": " << scheduledTasks << ",\n";
+
+    // Everything else that decides which runs happen and how, so the run can be repeated from the manifest
+    auto quoted = [](const std::string& text) { return "\"" + text + "\""; };
+    outFile << "  \"sweep\": {\"params\": [";
+    for (std::size_t i = 0; i < parameterSweep.specs().size(); ++i) {
+        outFile << (i > 0 ? ", " : "") << quoted(parameterSweep.specs()[i]);
+    }
+    outFile << "], \"samples\": " << sweepSamples << ", \"sampleSeed\": " << sweepSeed << ", \"configurations\": [";
+    std::vector<ParameterSet> configurations = parameterSweep.empty() ? std::vector<ParameterSet>{} : parameterSweep.configurations();
+    for (std::size_t i = 0; i < configurations.size(); ++i) {
+        outFile << (i > 0 ? ", " : "") << quoted(ParameterSweep::label(configurations[i]));
+    }
+    outFile << "]},\n";
+    outFile << "  \"shard\": {\"index\": " << shardIndex << ", \"count\": " << shardCount << "},\n";
+    outFile << "  \"modes\": {\"lockstep\": " << (lockstepBatches ? "true" : "false") << ", \"cooperative\": " << cooperativeRuns
+            << ", \"forkAt\": " << forkStep << ", \"topK\": " << raceTopK << ", \"raceRound\": " << raceRoundHouses
+            << ", \"numa\": " << (numaPlacement ? "true" : "false") << ", \"sharedHouses\": " << quoted(sharedHouseSegment)
+            << ", \"resultCache\": " << quoted(resultCache.directory()) << ", \"outputArchive\": " << quoted(outputArchivePath) << "},\n";
+
+    outFile << "  \"houses\": [\n";
+    for (std::size_t i = 0; i < houseFiles.size(); ++i) {
+        outFile << "    {\"file\": \"" << houseFiles[i] << "\", \"hash\": \"" << fileHash(houseFiles[i]) << "\"}";
+        outFile << (i + 1 < houseFiles.size() ? ",\n" : "\n");
+    }
+    outFile << "  ],\n";
+
+    outFile << "  \"algorithms\": [\n";
+    for (std::size_t i = 0; i < algorithms.size(); ++i) {
+        outFile << "    {\"name\": \"" << algorithms[i].name << "\", \"library\": \"" << algorithms[i].libraryPath
+                << "\", \"hash\": \"" << fileHash(algorithms[i].libraryPath) << "\"}";
+        outFile << (i + 1 < algorithms.size() ? ",\n" : "\n");
+    }
+    outFile << "  ],\n";
+
+    // Hashes of the outputs make two runs comparable without diffing the files
+    const std::vector<std::string> outputs = {"summary.csv", "steps_history.json", "initial_house.json"};
+    outFile << "  \"outputs\": {\n";
+    for (std::size_t i = 0; i < outputs.size(); ++i) {
+        outFile << "    \"" << outputs[i] << "\": \"" << fileHash(outputs[i]) << "\"";
+        outFile << (i + 1 < outputs.size() ? ",\n" : "\n");
+    }
+    outFile << "  }\n";
+    outFile << "}\n";
+    outFile.close();
+
+    std::cout << "Run manifest written to " << filename << std::endl;
+}
+
+
+
+void MySimulator::applyParameters(AbstractAlgorithm& algo, const std::string& algorithmName, const ParameterSet& parameters) {
+    auto& parameterized = dynamic_cast<ParameterizedAlgorithm&>(algo);
+    for (const auto& [name, value] : parameters) {
+        if (!parameterized.setParameter(name, value)) {
+            simulatorLogger.log(Logger::WARNING, "Algorithm " + algorithmName + " has no parameter " + name);
+        }
+    }
+}
+
+
+
+std::unique_ptr<AbstractAlgorithm> MySimulator::createAlgorithm(const std::string& algorithmName) {
+    for (const auto& pair : AlgorithmRegistrar::getAlgorithmRegistrar()) {
+        if (pair.name() == algorithmName) {
+            return pair.create();
+        }
+    }
+    return nullptr;
+}
+
+// Sets up one house x algorithm simulation from scratch: loads the house, creates a fresh algorithm
+// instance and its sensors, and captures the run state. Called with resultsMutex held.
+bool MySimulator::prepareTask(const std::string& houseFile, const AlgorithmHandle& algoHandle, const ParameterSet& parameters,
+                              TaskRun& run, HouseSnapshot* houseSnapshot) {
+    simulatorLogger.log(Logger::INFO, "Starting task for algorithm: " + algoHandle.name + " on house: " + houseFile);
+
+    TiledHouse houseCopy;
+    if (!loadHouse(houseFile, houseCopy)) {
+        simulatorLogger.log(Logger::ERROR, "Failed to read house file: " + houseFile);
+        return false;
+    }
+    // The first task on a house records it as loaded, before any run touches it
+    if (houseSnapshot && std::get<0>(*houseSnapshot).empty()) {
+        *houseSnapshot = std::make_tuple(houseFile, houseCopy.toRows(), maxSteps, maxBattery);
+    }
+
+    // Every task gets its own algorithm instance, instances are never shared between runs
+    run.instance = createAlgorithm(algoHandle.name);
+    if (!run.instance) {
+        simulatorLogger.log(Logger::ERROR, "Error: Algorithm instance for " + algoHandle.name + " is null!");
+        return false;
+    }
+
+    std::string parameterLabel;
+    if (algoHandle.parameterized) {
+        applyParameters(*run.instance, algoHandle.name, parameters);
+        parameterLabel = ParameterSweep::label(parameters);
+    }
+
+    this->setAlgorithm(*run.instance, houseCopy, dockingStation, run.wallsSensor, run.dirtSensor, run.batteryMeter);
+    run.state = startRun(algoHandle.name, houseFile, std::move(houseCopy), *run.wallsSensor, *run.dirtSensor, *run.batteryMeter, parameterLabel);
+    return true;
+}
+
+// Runs one task to the end. Nothing is recorded or written, that is left to the caller. Only the setup is done
+// under the lock; the run itself works on run-local state, so tasks run in parallel.
+bool MySimulator::runTask(const std::string& houseFile, const AlgorithmHandle& algoHandle, const ParameterSet& parameters,
+                          SimulationResult& result, HouseSnapshot* houseSnapshot, double* elapsedSeconds) {
+    TaskRun run;
+    {
+        std::lock_guard<std::mutex> guard(resultsMutex);
+        if (!prepareTask(houseFile, algoHandle, parameters, run, houseSnapshot)) {
+            return false;
+        }
+    }
+    auto started = std::chrono::steady_clock::now();
+    result = this->runSimulation(*run.instance, run.state);
+    if (elapsedSeconds) {
+        *elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+    simulatorLogger.log(Logger::INFO, "Completed simulation for algorithm: " + algoHandle.name + " on house: " + houseFile);
+    return true;
+}
+
+// The trunk of a fork (-fork_at): runs the algorithm with the trunk parameters for `steps` steps and freezes the
+// run there. The trunk itself is not recorded. Returns false if the algorithm cannot be snapshotted or the run
+// ended before that step, in which case there is nothing to branch from.
+bool MySimulator::takeSnapshot(const std::string& houseFile, const AlgorithmHandle& algoHandle, const ParameterSet& parameters,
+                               std::size_t steps, RunSnapshot& snapshot, HouseSnapshot* houseSnapshot) {
+    TaskRun run;
+    {
+        std::lock_guard<std::mutex> guard(resultsMutex);
+        if (!prepareTask(houseFile, algoHandle, parameters, run, houseSnapshot)) {
+            return false;
+        }
+    }
+    RunState& state = run.state;
+    TiledHouse original = state.house;
+    while (state.active() && state.numSteps < static_cast<int>(steps)) {
+        advanceRun(state, run.instance->nextStep());
+    }
+    if (state.liveRun) {
+        liveFeed.endRun(state.liveRun, "FORKED", state.numSteps, state.dirtLeft, 0);
+    }
+    auto* snapshotter = dynamic_cast<SnapshotAlgorithm*>(run.instance.get());
+    if (!snapshotter || !state.active()) {
+        simulatorLogger.log(Logger::INFO, state.logPrefix + " Ended before step " + std::to_string(steps) + ", its configurations run from the start");
+        return false;
+    }
+
+    snapshot.position = state.currentPosition;
+    snapshot.battery = run.batteryMeter->getBatteryState();
+    snapshot.dirtReading = run.dirtSensor->dirtLevel();
+    snapshot.numSteps = state.numSteps;
+    snapshot.dirtLeft = state.dirtLeft;
+    snapshot.inDock = state.inDock;
+    snapshot.status = state.status;
+    snapshot.stepsHistory = std::make_shared<const std::vector<std::tuple<int, int>>>(std::move(state.stepsHistory));
+    snapshot.dirtDelta = state.house.changedCells(original);
+    snapshot.algorithmState = snapshotter->saveState();
+    simulatorLogger.log(Logger::INFO, state.logPrefix + " Snapshot at step " + std::to_string(state.numSteps) + ": " +
+                                      std::to_string(snapshot.dirtDelta.size()) + " cells changed, algorithm state " +
+                                      std::to_string(snapshot.algorithmState.size()) + " bytes");
+    return true;
+}
+
+// A branch of a fork: a fresh run of the algorithm with its own parameters, put in the snapshot's state and
+// continued to the end. Only the setup is done under the lock; the branch itself runs on run-local state,
+// so branches of one snapshot run in parallel.
+bool MySimulator::forkTask(const RunSnapshot& snapshot, const std::string& houseFile, const AlgorithmHandle& algoHandle,
+                           const ParameterSet& parameters, SimulationResult& result, double* elapsedSeconds) {
+    TaskRun run;
+    {
+        std::lock_guard<std::mutex> guard(resultsMutex);
+        if (!prepareTask(houseFile, algoHandle, parameters, run, nullptr)) {
+            return false;
+        }
+    }
+    RunState& state = run.state;
+    // Copy-on-write: the branch starts from the house and takes over the cells the trunk changed
+    for (const auto& [cell, value] : snapshot.dirtDelta) {
+        state.house.set(cell / state.cols, cell % state.cols, value);
+    }
+    state.currentPosition = snapshot.position;
+    state.numSteps = snapshot.numSteps;
+    state.dirtLeft = snapshot.dirtLeft;
+    state.inDock = snapshot.inDock;
+    state.status = snapshot.status;
+    state.stepsHistory = *snapshot.stepsHistory;
+
+    int x = std::get<0>(state.currentPosition);
+    int y = std::get<1>(state.currentPosition);
+    run.wallsSensor->setWalls(y == 0 || state.house.isWall(x, y - 1), x == static_cast<int>(state.rows) - 1 || state.house.isWall(x + 1, y),
+                              y == static_cast<int>(state.cols) - 1 || state.house.isWall(x, y + 1), x == 0 || state.house.isWall(x - 1, y));
+    run.dirtSensor->setDirtLevel(snapshot.dirtReading);
+    run.batteryMeter->setBatteryState(snapshot.battery);
+
+    auto* snapshotter = dynamic_cast<SnapshotAlgorithm*>(run.instance.get());
+    if (!snapshotter || !snapshotter->restoreState(snapshot.algorithmState)) {
+        simulatorLogger.log(Logger::ERROR, state.logPrefix + " Could not restore the algorithm state of the snapshot");
+        if (state.liveRun) {
+            liveFeed.endRun(state.liveRun, "FORKED", state.numSteps, state.dirtLeft, 0);
+        }
+        return false;
+    }
+    auto started = std::chrono::steady_clock::now();
+    result = runSimulation(*run.instance, state);
+    if (elapsedSeconds) {
+        *elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+    result.parameters = forkedLabel(result.parameters, forkStep);
+    simulatorLogger.log(Logger::INFO, "Completed forked simulation for algorithm: " + algoHandle.name + " on house: " + houseFile);
+    return true;
+}
+
+// Lockstep worker: the tasks of one house x algorithm pair (its sweep configurations) form a batch that is
+// advanced with LockstepBatch, one step of every lane per round. The house is loaded once per batch, and
+// batches are handed out to the workers the way single tasks are otherwise.
+void MySimulator::runLockstep(const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms,
+                              const std::vector<ParameterSet>& configurations, const std::vector<SimulationTask>& tasks,
+                              const std::vector<std::size_t>& taskSlots, std::vector<HouseSnapshot>& houses,
+                              const std::vector<std::vector<std::size_t>>& batches, std::atomic<std::size_t>& nextBatch) {
+    for (std::size_t b = nextBatch++; b < batches.size(); b = nextBatch++) {
+        const std::vector<std::size_t>& batchTasks = batches[b];
+        const std::string& houseFile = houseFiles[tasks[batchTasks.front()].houseIndex];
+        const AlgorithmHandle& algoHandle = algorithms[tasks[batchTasks.front()].algorithmIndex];
+        std::size_t lanes = batchTasks.size();
+
+        try {
+            std::vector<std::unique_ptr<AbstractAlgorithm>> instances(lanes);
+            std::vector<std::string> labels(lanes);
+            std::unique_ptr<LockstepBatch> batch;
+            std::size_t batchMaxSteps = 0;
+            {
+                std::lock_guard<std::mutex> guard(resultsMutex);
+                TiledHouse houseCopy;
+                if (!loadHouse(houseFile, houseCopy)) {
+                    simulatorLogger.log(Logger::ERROR, "Failed to read house file: " + houseFile);
+                    continue;
+                }
+                batchMaxSteps = maxSteps;
+                if (std::get<0>(houses[tasks[batchTasks.front()].houseIndex]).empty()) {
+                    houses[tasks[batchTasks.front()].houseIndex] = std::make_tuple(houseFile, houseCopy.toRows(), maxSteps, maxBattery);
+                }
+                batch = std::make_unique<LockstepBatch>(houseCopy, dockingStation, maxSteps, maxBattery, initialDirtLevel, lanes);
+                bool created = true;
+                for (std::size_t lane = 0; lane < lanes && created; ++lane) {
+                    instances[lane] = createAlgorithm(algoHandle.name);
+                    if (!instances[lane]) {
+                        simulatorLogger.log(Logger::ERROR, "Error: Algorithm instance for " + algoHandle.name + " is null!");
+                        created = false;
+                        break;
+                    }
+                    if (algoHandle.parameterized) {
+                        const ParameterSet& parameters = configurations[tasks[batchTasks[lane]].configIndex];
+                        applyParameters(*instances[lane], algoHandle.name, parameters);
+                        labels[lane] = ParameterSweep::label(parameters);
+                    }
+                    instances[lane]->setMaxSteps(maxSteps);
+                    instances[lane]->setWallsSensor(batch->wallsSensor(lane));
+                    instances[lane]->setDirtSensor(batch->dirtSensor(lane));
+                    instances[lane]->setBatteryMeter(batch->batteryMeter(lane));
+                }
+                if (!created) {
+                    continue;
+                }
+                simulatorLogger.log(Logger::INFO, "Starting lockstep batch of " + std::to_string(lanes) + " runs for algorithm: " + algoHandle.name + " on house: " + houseFile);
+            }
+
+            std::vector<Step> steps(lanes, Step::Finish);
+            while (batch->anyActive()) {
+                for (std::size_t lane = 0; lane < lanes; ++lane) {
+                    if (batch->active(lane)) {
+                        steps[lane] = instances[lane]->nextStep();
+                    }
+                }
+                batch->step(steps);
+            }
+
+            for (std::size_t lane = 0; lane < lanes; ++lane) {
+                RunStatus status = batch->laneStatus(lane);
+                int score = calculateScore(batchMaxSteps, batch->laneSteps(lane), batch->laneDirtLeft(lane), batch->laneInDock(lane), status);
+                SimulationResult result = {houseFile, algoHandle.name, batch->laneSteps(lane), batch->laneDirtLeft(lane),
+                                           batch->laneInDock(lane), status, score, batch->laneHistory(lane), labels[lane]};
+                writeSimulationOutput(result);
+                std::lock_guard<std::mutex> guard(resultsMutex);
+                simulatorLogger.log(Logger::INFO, "[" + algoHandle.name + "," + houseFile + "] Recorded result for house: " + houseFile + " - Score: " + std::to_string(score));
+                recordResult(taskSlots[batchTasks[lane]], std::move(result));
+            }
+        } catch (const std::exception& e) {
+            simulatorLogger.log(Logger::ERROR, "Exception in lockstep batch for algorithm " + algoHandle.name + " on house: " + houseFile + ": " + e.what());
+        }
+    }
+}
+
+// Cooperative worker: keeps up to cooperativeRuns tasks in flight and advances them round-robin, one step
+// each, refilling from the shared task queue as runs end. Only the setup of a run takes resultsMutex; the
+// steps themselves touch nothing but the run's own state, so workers do not contend while stepping.
+// Algorithms derived from CoroutineAlgorithm are resumed once per step here like any other.
+void MySimulator::runCooperative(const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms,
+                                 const std::vector<ParameterSet>& configurations, const std::vector<SimulationTask>& tasks,
+                                 const std::vector<std::size_t>& taskSlots, std::vector<HouseSnapshot>& houses,
+                                 std::atomic<std::size_t>& nextTask) {
+    std::vector<std::unique_ptr<TaskRun>> active;  // Stable addresses: the algorithms hold references to the sensors
+    active.reserve(cooperativeRuns);
+    bool drained = false;
+
+    while (true) {
+        while (!drained && active.size() < cooperativeRuns) {
+            std::size_t taskIndex = nextTask++;
+            if (taskIndex >= tasks.size()) {
+                drained = true;
+                break;
+            }
+            const SimulationTask& task = tasks[taskIndex];
+            auto run = std::make_unique<TaskRun>();
+            run->slot = taskSlots[taskIndex];
+            try {
+                std::lock_guard<std::mutex> guard(resultsMutex);
+                if (!prepareTask(houseFiles[task.houseIndex], algorithms[task.algorithmIndex], configurations[task.configIndex],
+                                 *run, &houses[task.houseIndex])) {
+                    continue;
+                }
+            } catch (const std::exception& e) {
+                simulatorLogger.log(Logger::ERROR, "Exception preparing " + algorithms[task.algorithmIndex].name + " on house: " + houseFiles[task.houseIndex] + ": " + e.what());
+                continue;
+            }
+            active.push_back(std::move(run));
+        }
+        if (active.empty()) {
+            break;
+        }
+
+        for (std::size_t i = 0; i < active.size();) {
+            TaskRun& run = *active[i];
+            bool failed = false;
+            if (run.state.active()) {
+                try {
+                    advanceRun(run.state, run.instance->nextStep());
+                } catch (const std::exception& e) {
+                    simulatorLogger.log(Logger::ERROR, "Exception in algorithm " + run.state.algorithmName + " on house: " + run.state.houseName + ": " + e.what());
+                    failed = true;
+                }
+            }
+            if (run.state.active() && !failed) {
+                ++i;
+                continue;
+            }
+
+            if (!failed) {
+                SimulationResult result = finishRun(run.state);
+                writeSimulationOutput(result);
+                std::lock_guard<std::mutex> guard(resultsMutex);
+                recordResult(run.slot, std::move(result));
+            } else if (run.state.liveRun) {
+                // A failed run has no result, but the live feed still has to close it
+                liveFeed.endRun(run.state.liveRun, "FAILED", run.state.numSteps, run.state.dirtLeft, 0);
+            }
+            // Swap-remove; the order of runs in flight does not matter
+            active[i] = std::move(active.back());
+            active.pop_back();
+        }
+    }
+}
+
+
+
+// Racing for -top_k: houses are played in rounds of raceRoundHouses, in schedule order, and after every
+// round each configuration gets bounds on its total score (lower is better) from the houses it played and
+// the best and worst scores calculateScore allows on the houses it has left. A configuration that at least
+// K others are certain to beat cannot make the top K and is given no further tasks.
+void MySimulator::raceVariants(const std::vector<std::string>& houseFiles, const std::vector<std::string>& variantNames,
+                               const std::vector<SimulationTask>& tasks, const std::vector<std::size_t>& taskVariants,
+                               const std::function<void(const std::vector<SimulationTask>&)>& executeTasks) {
+    std::size_t variantCount = variantNames.size();
+
+    // Every unit of dirt costs at least one Stay step, or 300 points when it is left behind, and no outcome
+    // is worse than finishing outside the dock with all the dirt left
+    std::vector<long long> houseBest(houseFiles.size(), 0);
+    std::vector<long long> houseWorst(houseFiles.size(), 0);
+    {
+        std::lock_guard<std::mutex> guard(resultsMutex);
+        for (std::size_t h = 0; h < houseFiles.size(); ++h) {
+            TiledHouse house;
+            if (!loadHouse(houseFiles[h], house)) {
+                continue;  // Its tasks fail for every configuration alike
+            }
+            long long dirt = initialDirtLevel;
+            long long steps = static_cast<long long>(maxSteps);
+            houseBest[h] = dirt <= steps ? dirt : steps + 300 * (dirt - steps);
+            houseWorst[h] = steps + 300 * dirt + 3000;
+        }
+    }
+
+    std::vector<std::size_t> houseOrder;
+    std::vector<bool> ordered(houseFiles.size(), false);
+    for (const auto& task : tasks) {
+        if (!ordered[task.houseIndex]) {
+            ordered[task.houseIndex] = true;
+            houseOrder.push_back(task.houseIndex);
+        }
+    }
+
+    long long totalBest = 0;
+    long long totalWorst = 0;
+    for (std::size_t h = 0; h < houseFiles.size(); ++h) {
+        totalBest += houseBest[h];
+        totalWorst += houseWorst[h];
+    }
+    std::vector<long long> played(variantCount, 0);
+    std::vector<long long> pendingBest(variantCount, totalBest);
+    std::vector<long long> pendingWorst(variantCount, totalWorst);
+    std::vector<bool> alive(variantCount, true);
+    std::size_t aliveCount = variantCount;
+    std::size_t roundSize = std::max<std::size_t>(raceRoundHouses, 1);
+
+    for (std::size_t start = 0; start < houseOrder.size(); start += roundSize) {
+        std::vector<bool> inRound(houseFiles.size(), false);
+        std::size_t end = std::min(start + roundSize, houseOrder.size());
+        for (std::size_t i = start; i < end; ++i) {
+            inRound[houseOrder[i]] = true;
+        }
+
+        std::vector<SimulationTask> roundTasks;
+        for (std::size_t t = 0; t < tasks.size(); ++t) {
+            if (inRound[tasks[t].houseIndex] && alive[taskVariants[t]]) {
+                roundTasks.push_back(tasks[t]);
+            }
+        }
+        executeTasks(roundTasks);
+
+        for (std::size_t i = start; i < end; ++i) {
+            std::size_t h = houseOrder[i];
+            for (std::size_t v = 0; v < variantCount; ++v) {
+                if (!alive[v]) {
+                    continue;
+                }
+                const RunRecord& result = simulationResults[h * variantCount + v];
+                played[v] += result.empty() ? houseWorst[h] : result.score;  // A failed run counts as the worst
+                pendingBest[v] -= houseBest[h];
+                pendingWorst[v] -= houseWorst[h];
+            }
+        }
+
+        if (end == houseOrder.size()) {
+            break;  // Everything left has run on every house
+        }
+
+        // Eliminated configurations keep their last bounds, which are still valid
+        std::vector<std::size_t> eliminated;
+        for (std::size_t v = 0; v < variantCount; ++v) {
+            if (!alive[v]) {
+                continue;
+            }
+            long long lowest = played[v] + pendingBest[v];
+            std::size_t certainlyBetter = 0;
+            for (std::size_t u = 0; u < variantCount; ++u) {
+                if (u != v && played[u] + pendingWorst[u] < lowest) {
+                    certainlyBetter++;
+                }
+            }
+            if (certainlyBetter >= raceTopK) {
+                eliminated.push_back(v);
+            }
+        }
+        for (std::size_t v : eliminated) {
+            alive[v] = false;
+            aliveCount--;
+            std::cout << "Race: dropped " << variantNames[v] << " after " << end << " of " << houseOrder.size() << " houses" << std::endl;
+            simulatorLogger.log(Logger::INFO, "Race: dropped " + variantNames[v] + " after " + std::to_string(end) + " houses, score so far " + std::to_string(played[v]));
+        }
+    }
+
+    std::vector<std::size_t> ranking;
+    for (std::size_t v = 0; v < variantCount; ++v) {
+        if (alive[v]) {
+            ranking.push_back(v);
+        }
+    }
+    std::stable_sort(ranking.begin(), ranking.end(), [&](std::size_t a, std::size_t b) { return played[a] < played[b]; });
+    std::cout << "Race for the top " << raceTopK << ": " << aliveCount << " of " << variantCount << " configurations ran on every house" << std::endl;
+    for (std::size_t i = 0; i < std::min(ranking.size(), raceTopK); ++i) {
+        std::cout << "  " << i + 1 << ". " << variantNames[ranking[i]] << " total score " << played[ranking[i]] << std::endl;
+    }
+}
+
+
+
+// NUMA placement for -numa: the worker threads are split between the nodes in proportion to their CPUs, and each
+// house is given a home node, largest houses first, on the node with the least work per thread so far. A thread
+// pinned to the node then writes the node's replica of its houses, so first-touch allocation puts the replica in
+// that node's memory; loadHouse copies from it on the workers of the same node.
+void MySimulator::placeHouses(const std::vector<std::string>& houseFiles, int numThreads,
+                              std::vector<std::size_t>& houseNode, std::vector<std::size_t>& nodeThreads) {
+    numaTopology = NumaTopology::detect();
+    std::size_t nodes = numaTopology.nodeCount();
+    std::size_t totalThreads = std::max<std::size_t>(std::max(numThreads, 1), nodes);
+    std::size_t totalCpus = std::max<std::size_t>(numaTopology.cpuCount(), 1);
+    nodeThreads.assign(nodes, 1);
+    std::size_t assigned = nodes;
+    for (std::size_t node = 0; node < nodes && assigned < totalThreads; ++node) {
+        std::size_t share = totalThreads * numaTopology.cpus(node).size() / totalCpus;
+        std::size_t extra = std::min(share > 0 ? share - 1 : 0, totalThreads - assigned);
+        nodeThreads[node] += extra;
+        assigned += extra;
+    }
+    for (std::size_t node = 0; assigned < totalThreads; node = (node + 1) % nodes) {
+        nodeThreads[node]++;
+        assigned++;
+    }
+
+    std::vector<StoredHouse> parsed(houseFiles.size());
+    std::vector<std::size_t> order;
+    {
+        std::lock_guard<std::mutex> guard(resultsMutex);
+        for (std::size_t h = 0; h < houseFiles.size(); ++h) {
+            if (loadStoredHouse(houseFiles[h], parsed[h])) {
+                order.push_back(h);
+            }
+        }
+    }
+    // A run costs about maxSteps steps plus one copy of the cells
+    auto cost = [&](std::size_t h) { return parsed[h].maxSteps + parsed[h].cells.size(); };
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return cost(a) > cost(b); });
+    std::vector<double> load(nodes, 0.0);
+    std::vector<std::vector<std::size_t>> nodeHouses(nodes);
+    for (std::size_t h : order) {
+        std::size_t best = 0;
+        for (std::size_t node = 1; node < nodes; ++node) {
+            if (load[node] / nodeThreads[node] < load[best] / nodeThreads[best]) {
+                best = node;
+            }
+        }
+        houseNode[h] = best;
+        load[best] += static_cast<double>(cost(h));
+        nodeHouses[best].push_back(h);
+    }
+
+    numaReplicas.assign(nodes, {});
+    std::vector<std::thread> writers;
+    for (std::size_t node = 0; node < nodes; ++node) {
+        writers.emplace_back([&, node]() {
+            numaTopology.pinToNode(node);
+            for (std::size_t h : nodeHouses[node]) {
+                numaReplicas[node].emplace(houseFiles[h], parsed[h]);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    std::string placement;
+    for (std::size_t node = 0; node < nodes; ++node) {
+        placement += " node " + std::to_string(node) + ": " + std::to_string(nodeHouses[node].size()) + " houses, " +
+                     std::to_string(nodeThreads[node]) + " threads on " + std::to_string(numaTopology.cpus(node).size()) + " cpus;";
+    }
+    std::lock_guard<std::mutex> guard(resultsMutex);
+    simulatorLogger.log(Logger::INFO, "NUMA placement:" + placement);
+}
+
+void MySimulator::runSimulations(const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms, int numThreads) {
+    // Algorithms without parameters run once, parameterized ones once per sweep configuration
+    std::vector<ParameterSet> configurations = parameterSweep.configurations();
+    std::vector<std::pair<std::size_t, std::size_t>> variants;
+    for (std::size_t a = 0; a < algorithms.size(); ++a) {
+        std::size_t configCount = algorithms[a].parameterized ? configurations.size() : 1;
+        for (std::size_t c = 0; c < configCount; ++c) {
+            variants.emplace_back(a, c);
+        }
+    }
+    // The cost model times each configuration separately
+    std::vector<std::string> variantLabels;
+    for (const auto& variant : variants) {
+        variantLabels.push_back(algorithms[variant.first].parameterized ? ParameterSweep::label(configurations[variant.second]) : "");
+    }
+
+    // One result slot per (house, variant) pair so the output order never depends on thread timing, and one
+    // house snapshot per house, filled by whichever task loads the house first
+    std::vector<HouseSnapshot> houses(houseFiles.size());
+
+    {
+        std::lock_guard<std::mutex> guard(resultsMutex);
+        simulatorLogger.log(Logger::INFO, "Starting simulations with " + std::to_string(houseFiles.size()) + " houses and " + std::to_string(algorithms.size()) + " algorithms (" + std::to_string(variants.size()) + " configurations), using " + std::to_string(numThreads) + " threads.");
+        resetResults(houseFiles.size() * variants.size());
+    }
+
+    // Tasks are dispatched longest first, by the cost model's estimate
+    costModel.setPath(taskHistoryPath.empty() ? ".task_history" : taskHistoryPath);
+    costModel.load();
+    std::vector<HouseShape> houseShapes(houseFiles.size());
+    std::vector<double> taskCosts;
+    taskCosts.reserve(houseFiles.size() * variants.size());
+    for (std::size_t h = 0; h < houseFiles.size(); ++h) {
+        readHouseShape(houseFiles[h], houseShapes[h]);
+        for (std::size_t v = 0; v < variants.size(); ++v) {
+            taskCosts.push_back(costModel.estimate(algorithms[variants[v].first].name, variantLabels[v], houseShapes[h]));
+        }
+    }
+
+    std::vector<SimulationTask> tasks = scheduleTasks(houseFiles.size(), variants, taskCosts);
+    scheduledTasks = tasks.size();
+    std::vector<std::size_t> variantIndex(algorithms.size() * configurations.size());
+    for (std::size_t v = 0; v < variants.size(); ++v) {
+        variantIndex[variants[v].first * configurations.size() + variants[v].second] = v;
+    }
+    auto variantOf = [&](const SimulationTask& task) {
+        return variantIndex[task.algorithmIndex * configurations.size() + task.configIndex];
+    };
+
+    // With -numa every house has a home node holding its replica, and its tasks run on that node's workers
+    std::vector<std::size_t> houseNode(houseFiles.size(), 0);
+    std::vector<std::size_t> nodeThreads{static_cast<std::size_t>(std::max(numThreads, 1))};
+    if (numaPlacement) {
+        placeHouses(houseFiles, numThreads, houseNode, nodeThreads);
+    }
+
+    // With -fork_at every parameterized algorithm runs one trunk per house, with the first configuration, and all
+    // of its configurations branch off the trunk's snapshot. The first task to need a snapshot runs the trunk,
+    // the others wait for it; a null snapshot means the configurations run from the start.
+    if (forkStep > 0 && (lockstepBatches || cooperativeRuns > 0)) {
+        std::cerr << "-fork_at only applies to the default execution mode and is ignored with -lockstep and -cooperative." << std::endl;
+    }
+    auto forks = [&](const SimulationTask& task) {
+        const AlgorithmHandle& algoHandle = algorithms[task.algorithmIndex];
+        return forkStep > 0 && !lockstepBatches && cooperativeRuns == 0 && algoHandle.parameterized && algoHandle.snapshots;
+    };
+    std::mutex forkPointsMutex;
+    std::map<std::pair<std::size_t, std::size_t>, std::shared_future<std::shared_ptr<const RunSnapshot>>> forkPoints;
+    auto forkPoint = [&](const SimulationTask& task) {
+        std::promise<std::shared_ptr<const RunSnapshot>> trunk;
+        std::shared_future<std::shared_ptr<const RunSnapshot>> snapshot;
+        bool runTrunk = false;
+        {
+            std::lock_guard<std::mutex> guard(forkPointsMutex);
+            auto [found, inserted] = forkPoints.try_emplace({task.houseIndex, task.algorithmIndex});
+            if (inserted) {
+                found->second = trunk.get_future().share();
+                runTrunk = true;
+            }
+            snapshot = found->second;
+        }
+        if (runTrunk) {
+            auto taken = std::make_shared<RunSnapshot>();
+            bool ok = false;
+            try {
+                ok = takeSnapshot(houseFiles[task.houseIndex], algorithms[task.algorithmIndex], configurations.front(), forkStep,
+                                  *taken, &houses[task.houseIndex]);
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> guard(resultsMutex);
+                simulatorLogger.log(Logger::ERROR, "Exception in the trunk of " + algorithms[task.algorithmIndex].name + " on house: " + houseFiles[task.houseIndex] + ": " + e.what());
+            }
+            trunk.set_value(ok ? std::move(taken) : nullptr);
+        }
+        return snapshot.get();
+    };
+
+    // With -result_cache a run whose house file, plugin binary and configuration were seen before is served from
+    // the cache: its output file is written from the cached trace and nothing runs. A branch of a -fork_at trunk
+    // is cached apart from the full run of its configuration.
+    std::size_t cacheHits = 0;
+    std::size_t cacheLookups = 0;
+    auto cacheKey = [&](const SimulationTask& task) {
+        const AlgorithmHandle& algoHandle = algorithms[task.algorithmIndex];
+        ResultCache::Key key{houseShapes[task.houseIndex].hash, algoHandle.libraryHash, algoHandle.name,
+                             algoHandle.parameterized ? configurations[task.configIndex] : ParameterSet{}, 0, {}};
+        if (forks(task)) {
+            key.forkStep = forkStep;
+            key.trunkParameters = configurations.front();
+        }
+        return key;
+    };
+    auto cacheLabel = [&](const ResultCache::Key& key) {
+        std::string label = ParameterSweep::label(key.parameters);
+        return key.forkStep > 0 ? forkedLabel(label, key.forkStep) : label;
+    };
+    auto serveFromCache = [&](const SimulationTask& task) {
+        ResultCache::Entry cached;
+        if (houseShapes[task.houseIndex].hash == 0 || algorithms[task.algorithmIndex].libraryHash == 0 ||
+            !resultCache.lookup(cacheKey(task), cached)) {
+            return false;
+        }
+        const std::string& houseFile = houseFiles[task.houseIndex];
+        SimulationResult result{houseFile, algorithms[task.algorithmIndex].name, cached.numSteps, cached.dirtLeft, cached.inDock,
+                                cached.status, cached.score, {}, cacheLabel(cacheKey(task))};
+        result.stepsHistory.reserve(cached.steps.size() + 1);
+        result.stepsHistory.emplace_back(cached.dockRow, cached.dockCol);
+        for (char step : cached.steps) {
+            auto [x, y] = result.stepsHistory.back();
+            switch (step) {
+                case 'N': y -= 1; break;
+                case 'E': x += 1; break;
+                case 'S': y += 1; break;
+                case 'W': x -= 1; break;
+                case 's': break;
+                default: continue;  // 'F'
+            }
+            result.stepsHistory.emplace_back(x, y);
+        }
+
+        std::lock_guard<std::mutex> guard(resultsMutex);
+        // initial_house.json still needs the house, which is loaded but not run
+        HouseSnapshot& houseSnapshot = houses[task.houseIndex];
+        if (std::get<0>(houseSnapshot).empty()) {
+            TiledHouse houseMatrix;
+            if (!loadHouse(houseFile, houseMatrix)) {
+                return false;
+            }
+            houseSnapshot = std::make_tuple(houseFile, houseMatrix.toRows(), maxSteps, maxBattery);
+        }
+        simulatorLogger.log(Logger::INFO, "Served algorithm: " + result.algorithmName + " on house: " + houseFile + " from the result cache");
+        writeSimulationOutput(result);
+        recordResult(task.houseIndex * variants.size() + variantOf(task), std::move(result));
+        return true;
+    };
+    auto storeInCache = [&](const SimulationTask& task) {
+        std::size_t slot = task.houseIndex * variants.size() + variantOf(task);
+        const RunRecord& result = simulationResults[slot];
+        const std::vector<std::tuple<int, int>>& stepsHistory = stepsHistories[slot];
+        if (result.empty() || stepsHistory.empty() || houseShapes[task.houseIndex].hash == 0 ||
+            algorithms[task.algorithmIndex].libraryHash == 0) {
+            return;
+        }
+        // A task meant to fork that ran from the start, because its trunk failed, is not the run its key names
+        ResultCache::Key key = cacheKey(task);
+        if (resultParameters.name(result.parametersId) != cacheLabel(key)) {
+            return;
+        }
+        ResultCache::Entry entry{result.numSteps, result.dirtLeft, result.inDock, result.status, result.score,
+                                 std::get<0>(stepsHistory.front()), std::get<1>(stepsHistory.front()), ""};
+        entry.steps.reserve(stepsHistory.size());
+        for (std::size_t i = 1; i < stepsHistory.size(); ++i) {
+            entry.steps += calculateDirectionFromSteps(stepsHistory[i - 1], stepsHistory[i]);
+        }
+        if (!resultCache.store(key, entry)) {
+            simulatorLogger.log(Logger::WARNING, "Could not store the result of " + algorithms[task.algorithmIndex].name + " on " + houseFiles[task.houseIndex] + " in the result cache");
+        }
+    };
+
+    // Runs a list of tasks on the worker threads and returns once all of them are done
+    auto runTasks = [&](const std::vector<SimulationTask>& allTasks) {
+        // One group of tasks on its own workers, pinned to the cores of `node` with -numa
+        auto runGroup = [&](const std::vector<SimulationTask>& tasks, std::size_t threadCount, std::size_t node) {
+            std::vector<std::size_t> taskSlots(tasks.size());
+            for (std::size_t t = 0; t < tasks.size(); ++t) {
+                taskSlots[t] = tasks[t].houseIndex * variants.size() + variantOf(tasks[t]);
+            }
+            std::atomic<std::size_t> nextTask{0};
+
+            // In lockstep mode the unit of work is a batch of tasks, in the order the first task of each was scheduled
+            std::vector<std::vector<std::size_t>> batches;
+            if (lockstepBatches) {
+                std::map<std::pair<std::size_t, std::size_t>, std::size_t> batchOf;
+                for (std::size_t t = 0; t < tasks.size(); ++t) {
+                    auto key = std::make_pair(tasks[t].houseIndex, tasks[t].algorithmIndex);
+                    auto found = batchOf.find(key);
+                    if (found == batchOf.end()) {
+                        found = batchOf.emplace(key, batches.size()).first;
+                        batches.emplace_back();
+                    }
+                    batches[found->second].push_back(t);
+                }
+            }
+
+            auto worker = [&](std::size_t workerIndex) {
+                if (numaPlacement && !numaTopology.cpus(node).empty()) {
+                    const std::vector<int>& cpus = numaTopology.cpus(node);
+                    NumaTopology::pinToCpu(cpus[workerIndex % cpus.size()]);
+                }
+                if (lockstepBatches) {
+                    runLockstep(houseFiles, algorithms, configurations, tasks, taskSlots, houses, batches, nextTask);
+                    return;
+                }
+                if (cooperativeRuns > 0) {
+                    runCooperative(houseFiles, algorithms, configurations, tasks, taskSlots, houses, nextTask);
+                    return;
+                }
+                for (std::size_t taskIndex = nextTask++; taskIndex < tasks.size(); taskIndex = nextTask++) {
+                    const SimulationTask& task = tasks[taskIndex];
+                    const std::string& houseFile = houseFiles[task.houseIndex];
+                    const AlgorithmHandle& algoHandle = algorithms[task.algorithmIndex];
+                    std::size_t slot = taskSlots[taskIndex];
+                    const ParameterSet& parameters = configurations[task.configIndex];
+
+                    try {
+                        SimulationResult result;
+                        // Only the simulation is timed, not the wait for the lock or the fork point
+                        double elapsed = 0;
+                        bool completed = false;
+                        if (forks(task)) {
+                            std::shared_ptr<const RunSnapshot> snapshot = forkPoint(task);
+                            completed = snapshot && forkTask(*snapshot, houseFile, algoHandle, parameters, result, &elapsed);
+                        }
+                        if (completed || runTask(houseFile, algoHandle, parameters, result, &houses[task.houseIndex], &elapsed)) {
+                            writeSimulationOutput(result);
+                            std::lock_guard<std::mutex> guard(resultsMutex);
+                            recordResult(slot, std::move(result));
+                            costModel.record(algoHandle.name, variantLabels[variantOf(task)], houseShapes[task.houseIndex], elapsed);
+                        }
+                    } catch (const std::exception& e) {
+                        std::lock_guard<std::mutex> guard(resultsMutex);
+                        simulatorLogger.log(Logger::ERROR, "Exception in thread for algorithm " + algoHandle.name + " on house: " + houseFile + ": " + e.what());
+                    } catch (...) {
+                        std::lock_guard<std::mutex> guard(resultsMutex);
+                        simulatorLogger.log(Logger::ERROR, "Unknown exception in thread for algorithm " + algoHandle.name + " on house: " + houseFile);
+                    }
+                }
+            };
+
+            std::vector<std::thread> threads;
+            std::size_t workerCount = std::min<std::size_t>(threadCount, std::max<std::size_t>(tasks.size(), 1));
+            for (std::size_t i = 0; i < workerCount; ++i) {
+                threads.emplace_back(worker, i);
+            }
+            for (auto& thread : threads) {
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+        };
+
+        if (!numaPlacement) {
+            runGroup(allTasks, nodeThreads[0], 0);
+            return;
+        }
+        std::vector<std::vector<SimulationTask>> nodeTasks(nodeThreads.size());
+        for (const auto& task : allTasks) {
+            nodeTasks[houseNode[task.houseIndex]].push_back(task);
+        }
+        std::vector<std::thread> groups;
+        for (std::size_t node = 0; node < nodeTasks.size(); ++node) {
+            if (!nodeTasks[node].empty()) {
+                groups.emplace_back(runGroup, std::cref(nodeTasks[node]), nodeThreads[node], node);
+            }
+        }
+        for (auto& group : groups) {
+            group.join();
+        }
+    };
+
+    // Serves what it can from the result cache, runs the rest and caches their results
+    auto executeTasks = [&](const std::vector<SimulationTask>& requestedTasks) {
+        if (!resultCache.enabled()) {
+            runTasks(requestedTasks);
+            return;
+        }
+        std::vector<SimulationTask> misses;
+        cacheLookups += requestedTasks.size();
+        for (const auto& task : requestedTasks) {
+            if (serveFromCache(task)) {
+                cacheHits++;
+            } else {
+                misses.push_back(task);
+            }
+        }
+        runTasks(misses);
+        for (const auto& task : misses) {
+            storeInCache(task);
+        }
+    };
+
+    // Shards share the working directory, so each writes its own archive
+    std::string archivePath = outputArchivePath;
+    if (shardCount > 1 && !archivePath.empty()) {
+        archivePath += "." + std::to_string(shardIndex);
+    }
+    if (!outputWriter.start(archivePath)) {
+        simulatorLogger.log(Logger::WARNING, "Output writer unavailable, writing output files from the workers");
+    }
+
+    if (raceTopK > 0 && shardCount > 1) {
+        std::cerr << "-top_k needs every result in one process and is ignored with -shard." << std::endl;
+    }
+
+    if (raceTopK > 0 && raceTopK < variants.size() && shardCount <= 1) {
+        std::vector<std::string> variantNames;
+        for (const auto& [algorithmIndex, configIndex] : variants) {
+            variantNames.push_back(algorithms[algorithmIndex].name +
+                                   (algorithms[algorithmIndex].parameterized ? " [" + ParameterSweep::label(configurations[configIndex]) + "]" : ""));
+        }
+        std::vector<std::size_t> taskVariants;
+        for (const auto& task : tasks) {
+            taskVariants.push_back(variantOf(task));
+        }
+        raceVariants(houseFiles, variantNames, tasks, taskVariants, executeTasks);
+    } else {
+        executeTasks(tasks);
+    }
+
+    std::size_t outputCount = outputWriter.finish();
+    numaReplicas.clear();
+    if (!costModel.save()) {
+        simulatorLogger.log(Logger::WARNING, "Could not write the task history");
+    }
+    std::cout << "Generated " << outputCount << " output files" << (archivePath.empty() ? "" : " in " + archivePath) << "." << std::endl;
+    if (resultCache.enabled()) {
+        std::cout << "Served " << cacheHits << " of " << cacheLookups << " runs from the result cache." << std::endl;
+    }
+
+    // A shard only records its part; `simulator merge` writes the outputs once every shard is done
+    if (shardCount > 1) {
+        std::string shardFile = "results-" + std::to_string(shardIndex) + "-of-" + std::to_string(shardCount) + ".shard";
+        if (!writeShardResults(shardFile, houses)) {
+            std::cerr << "Failed to write " << shardFile << std::endl;
+        }
+        return;
+    }
+
+    // Tasks that failed leave an empty slot behind, which the writers skip
+    houses.erase(std::remove_if(houses.begin(), houses.end(), [](const auto& house) {
+        return std::get<0>(house).empty();
+    }), houses.end());
 
-    summaryFile.close();
-
-    std::cout << "Summary CSV generated successfully." << std::endl;
-
+    writeResults(houses);
 }
 
-int MySimulator::calculateScore(int maxSteps, int numSteps, int dirtLeft, bool inDock, const std::string& status) {
-    simulatorLogger.log(Logger::WARNING, "[" + std::to_string(maxSteps) + "] -maxSteps");
-    simulatorLogger.log(Logger::WARNING, "[" + std::to_string(numSteps) + "] -numSteps");
-    simulatorLogger.log(Logger::WARNING, "[" + std::to_string(dirtLeft) + "] -dirtLeft");
-    simulatorLogger.log(Logger::WARNING, "[" + status + "] -status");
-     
+// Clears the results for a tournament of `slots` runs
+void MySimulator::resetResults(std::size_t slots) {
+    simulationResults.assign(slots, RunRecord{});
+    stepsHistories.assign(slots, {});
+    resultHouses.clear();
+    resultAlgorithms.clear();
+    resultParameters.clear();
+}
+
+// Stores the result of the run in its slot, as a record with interned names and its trace. The caller holds
+// resultsMutex.
+void MySimulator::recordResult(std::size_t slot, SimulationResult&& result) {
+    RunRecord& record = simulationResults[slot];
+    record.houseId = resultHouses.intern(result.houseName);
+    record.algorithmId = resultAlgorithms.intern(result.algorithmName);
+    record.parametersId = resultParameters.intern(result.parameters);
+    record.numSteps = result.numSteps;
+    record.dirtLeft = result.dirtLeft;
+    record.score = result.score;
+    record.status = result.status;
+    record.inDock = result.inDock;
+    stepsHistories[slot] = std::move(result.stepsHistory);
+}
+
+// summary.csv, steps_history.json and initial_house.json for a whole tournament, from the recorded slots
+void MySimulator::writeResults(const std::vector<HouseSnapshot>& houses) {
+    generateSummaryCSV();
+
+    std::vector<std::tuple<std::string, std::string, std::vector<std::tuple<int, int>>, std::tuple<int, int>, int, std::string>> stepsHistoryData;
+
+    for (std::size_t slot = 0; slot < simulationResults.size(); ++slot) {
+        const RunRecord& result = simulationResults[slot];
+        if (result.empty()) {
+            continue;
+        }
+        const std::vector<std::tuple<int, int>>& stepsHistory = stepsHistories[slot];
+        stepsHistoryData.emplace_back(resultHouses.name(result.houseId), resultAlgorithms.name(result.algorithmId), stepsHistory,
+                                      stepsHistory.front(), result.score, resultParameters.name(result.parametersId));
+    }
+
+    writeStepsHistory("steps_history.json", stepsHistoryData);
+    writeHouseMatrix("initial_house.json", houses);
+
+}
+
+// Partial results of one shard, one tab-separated line per run and per house, keyed by the slot the run and the
+// house have in the whole tournament so the merge can put them back in the order of a single-process run:
+//   result <slot> house algorithm parameters numSteps dirtLeft inDock status score steps ("x,y" separated by spaces)
+//   house <index> houseName maxSteps maxBattery rows cols cells (rows * cols characters, row-major)
+bool MySimulator::writeShardResults(const std::string& filename, const std::vector<HouseSnapshot>& houses) {
+    std::string temporaryPath = filename + ".tmp";
+    {
+        std::ofstream outFile(temporaryPath, std::ios::trunc);
+        if (!outFile) {
+            return false;
+        }
+        outFile << kShardHeader << "\n";
+        outFile << "shard\t" << shardIndex << "\t" << shardCount << "\n";
+        for (std::size_t slot = 0; slot < simulationResults.size(); ++slot) {
+            const RunRecord& result = simulationResults[slot];
+            if (result.empty()) {
+                continue;
+            }
+            outFile << "result\t" << slot << '\t' << resultHouses.name(result.houseId) << '\t' << resultAlgorithms.name(result.algorithmId)
+                    << '\t' << resultParameters.name(result.parametersId) << '\t' << result.numSteps << '\t' << result.dirtLeft << '\t'
+                    << (result.inDock ? 1 : 0) << '\t' << statusName(result.status) << '\t' << result.score << '\t';
+            const std::vector<std::tuple<int, int>>& stepsHistory = stepsHistories[slot];
+            for (std::size_t i = 0; i < stepsHistory.size(); ++i) {
+                outFile << (i ? " " : "") << std::get<0>(stepsHistory[i]) << ',' << std::get<1>(stepsHistory[i]);
+            }
+            outFile << "\n";
+        }
+        for (std::size_t index = 0; index < houses.size(); ++index) {
+            const auto& [houseName, houseMatrix, houseMaxSteps, houseMaxBattery] = houses[index];
+            if (houseName.empty()) {
+                continue;
+            }
+            std::size_t houseCols = houseMatrix.empty() ? 0 : houseMatrix[0].size();
+            outFile << "house\t" << index << '\t' << houseName << '\t' << houseMaxSteps << '\t' << houseMaxBattery << '\t'
+                    << houseMatrix.size() << '\t' << houseCols << '\t';
+            for (const auto& row : houseMatrix) {
+                for (char cell : row) {
+                    // Tabs and line breaks would split the record; the visualizer shows them as empty floor anyway
+                    outFile << ((cell == '\t' || cell == '\n' || cell == '\r') ? ' ' : cell);
+                }
+            }
+            outFile << "\n";
+        }
+        if (!outFile) {
+            return false;
+        }
+    }
+    return std::rename(temporaryPath.c_str(), filename.c_str()) == 0;
+}
+
+// `simulator merge [<shard file or directory>...]`: reads the results of every shard of a sharded run (the
+// current directory by default) and writes summary.csv, steps_history.json and initial_house.json as a
+// single process would have. Refuses to merge when a shard is missing.
+void MySimulator::mergeShards(int argc, char** argv) {
+    std::vector<std::string> shardFiles;
+    auto addDirectory = [&](const std::string& directory) {
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (entry.path().extension() == ".shard") {
+                shardFiles.push_back(entry.path().string());
+            }
+        }
+    };
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (std::filesystem::is_directory(arg)) {
+            addDirectory(arg);
+        } else {
+            shardFiles.push_back(arg);
+        }
+    }
+    if (argc <= 2) {
+        addDirectory(".");
+    }
+    std::sort(shardFiles.begin(), shardFiles.end());
+    if (shardFiles.empty()) {
+        std::cerr << "Usage: simulator merge [<shard file or directory>...]" << std::endl;
+        return;
+    }
+
+    resetResults(0);
+    std::size_t mergedRuns = 0;
+    std::map<std::size_t, HouseSnapshot> houses;
+    std::set<std::size_t> shardsSeen;
+    std::size_t expectedShards = 0;
+    for (const auto& shardFile : shardFiles) {
+        std::ifstream file(shardFile);
+        std::string line;
+        if (!std::getline(file, line) || line != kShardHeader) {
+            std::cerr << "Skipping " << shardFile << ": not a shard result file" << std::endl;
+            continue;
+        }
+        std::size_t lineNumber = 1;
+        while (std::getline(file, line)) {
+            lineNumber++;
+            std::vector<std::string> fields;
+            std::stringstream stream(line);
+            std::string field;
+            while (std::getline(stream, field, '\t')) {
+                fields.push_back(field);
+            }
+            try {
+                if (fields.size() == 3 && fields[0] == "shard") {
+                    std::size_t count = std::stoul(fields[2]);
+                    if (expectedShards != 0 && count != expectedShards) {
+                        std::cerr << shardFile << " belongs to a run with " << count << " shards, not " << expectedShards << std::endl;
+                        return;
+                    }
+                    expectedShards = count;
+                    shardsSeen.insert(std::stoul(fields[1]));
+                } else if (fields.size() >= 10 && fields[0] == "result") {
+                    SimulationResult result;
+                    result.houseName = fields[2];
+                    result.algorithmName = fields[3];
+                    result.parameters = fields[4];
+                    result.numSteps = std::stoi(fields[5]);
+                    result.dirtLeft = std::stoi(fields[6]);
+                    result.inDock = fields[7] == "1";
+                    if (!parseStatus(fields[8], result.status)) {
+                        throw std::invalid_argument("unknown status " + fields[8]);
+                    }
+                    result.score = std::stoi(fields[9]);
+                    std::stringstream steps(fields.size() > 10 ? fields[10] : "");
+                    std::string position;
+                    while (steps >> position) {
+                        std::size_t comma = position.find(',');
+                        result.stepsHistory.emplace_back(std::stoi(position.substr(0, comma)), std::stoi(position.substr(comma + 1)));
+                    }
+                    if (result.stepsHistory.empty()) {
+                        throw std::invalid_argument("run without steps");
+                    }
+                    std::size_t slot = std::stoul(fields[1]);
+                    if (slot >= simulationResults.size()) {
+                        simulationResults.resize(slot + 1);
+                        stepsHistories.resize(slot + 1);
+                    }
+                    mergedRuns += simulationResults[slot].empty();
+                    recordResult(slot, std::move(result));
+                } else if (fields.size() >= 7 && fields[0] == "house") {
+                    std::size_t houseRows = std::stoul(fields[5]);
+                    std::size_t houseCols = std::stoul(fields[6]);
+                    std::string cells = fields.size() > 7 ? fields[7] : "";
+                    if (cells.size() != houseRows * houseCols) {
+                        throw std::invalid_argument("house cells do not match its size");
+                    }
+                    std::vector<std::vector<char>> matrix(houseRows);
+                    for (std::size_t row = 0; row < houseRows; ++row) {
+                        matrix[row].assign(cells.begin() + row * houseCols, cells.begin() + (row + 1) * houseCols);
+                    }
+                    houses.emplace(std::stoul(fields[1]), std::make_tuple(fields[2], std::move(matrix), std::stoi(fields[3]), std::stoi(fields[4])));
+                } else {
+                    throw std::invalid_argument("unknown record");
+                }
+            } catch (const std::exception& e) {
+                std::cerr << shardFile << ":" << lineNumber << ": " << e.what() << std::endl;
+                return;
+            }
+        }
+    }
+
+    for (std::size_t shard = 0; shard < expectedShards; ++shard) {
+        if (!shardsSeen.count(shard)) {
+            std::cerr << "Shard " << shard << " of " << expectedShards << " is missing, nothing was merged." << std::endl;
+            return;
+        }
+    }
+    if (expectedShards == 0) {
+        std::cerr << "No shard results found." << std::endl;
+        return;
+    }
+
+    std::vector<HouseSnapshot> mergedHouses;
+    for (auto& [index, house] : houses) {
+        mergedHouses.push_back(std::move(house));
+    }
+    writeResults(mergedHouses);
+    std::cout << "Merged " << mergedRuns << " runs on " << mergedHouses.size() << " houses from " << expectedShards << " shards." << std::endl;
+}
+
+
+
+
+
+
 
-    if (status == "DEAD") {
 
-        return maxSteps + dirtLeft * 300 + 2000;
 
-    } else if (status == "FINISHED" && !inDock) {
 
-        return maxSteps + dirtLeft * 300 + 3000;
 
+
+// Captures the current house (as set by loadHouse) and the sensors the algorithm was given
+MySimulator::RunState MySimulator::startRun(const std::string& algorithmName, const std::string& houseName,
+                                            TiledHouse houseCopy, ConcreteWallSensor& wallsSensor,
+                                            ConcreteDirtSensor& dirtSensor, ConcreteBatteryMeter& batteryMeter,
+                                            const std::string& parameters) {
+    RunState run;
+    run.algorithmName = algorithmName;
+    run.houseName = houseName;
+    run.parameters = parameters;
+    run.logPrefix = "[" + algorithmName + "," + houseName.substr(houseName.find_last_of("/\\") + 1) + "]";
+    run.house = std::move(houseCopy);
+    run.maxSteps = maxSteps;
+    run.maxBattery = maxBattery;
+    run.rows = rows;
+    run.cols = cols;
+    run.dockingStation = dockingStation;
+    run.currentPosition = dockingStation;
+    run.dirtLeft = initialDirtLevel;
+    run.stepsHistory.push_back(dockingStation);
+    run.wallsSensor = &wallsSensor;
+    run.dirtSensor = &dirtSensor;
+    run.batteryMeter = &batteryMeter;
+
+    simulatorLogger.log(Logger::INFO, run.logPrefix + " Starting simulation.");
+    if (liveFeed.running()) {
+        run.liveRun = liveFeed.beginRun(houseName, algorithmName, parameters, run.house.toRows(), std::get<0>(dockingStation),
+                                        std::get<1>(dockingStation), maxSteps, maxBattery);
+    }
+    if (run.maxBattery == 1) {
+        run.status = RunStatus::Finished;
+        run.inDock = true;
+    }
+    return run;
+}
+
+// Applies one step of the algorithm to the run
+void MySimulator::advanceRun(RunState& run, Step next) {
+    auto& houseCopy = run.house;
+    const std::string& logPrefix = run.logPrefix;
+    simulatorLogger.log(Logger::INFO, logPrefix + " Num of Steps: " + std::to_string(run.numSteps));
+    simulatorLogger.log(Logger::INFO, logPrefix + " Next step: " + std::to_string(static_cast<int>(next)));
+
+    // Determine the new position based on the step
+    int x = std::get<0>(run.currentPosition);
+    int y = std::get<1>(run.currentPosition);
+
+    switch (next) {
+        case Step::North: 
+            if (y > 0 && !houseCopy.isWall(x, y - 1)) y -= 1; 
+            else { run.status = RunStatus::Dead; break; }
+            break;
+        case Step::East: 
+            if (x < static_cast<int>(run.rows) - 1 && !houseCopy.isWall(x + 1, y)) x += 1; 
+            else { run.status = RunStatus::Dead; break; }
+            break;
+        case Step::South: 
+            if (y < static_cast<int>(run.cols) - 1 && !houseCopy.isWall(x, y + 1)) y += 1; 
+            else { run.status = RunStatus::Dead; break; }
+            break;
+        case Step::West: 
+            if (x > 0 && !houseCopy.isWall(x - 1, y)) x -= 1; 
+            else { run.status = RunStatus::Dead; break; }
+            break;
+        case Step::Finish:
+            run.status = RunStatus::Finished;
+            simulatorLogger.log(Logger::INFO, logPrefix + " Algorithm reported Finish, exiting loop");
+            break;
+        case Step::Stay:
+            simulatorLogger.log(Logger::INFO, logPrefix + " Algorithm decided to Stay at (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+            break;
+    }
+
+    if (run.status != RunStatus::Working) return;
+
+    run.currentPosition = std::make_tuple(x, y);
+    run.stepsHistory.push_back(run.currentPosition);  // Log the current position after each move
+    simulatorLogger.log(Logger::INFO, logPrefix + " Moved to position: (" + std::to_string(x) + ", " + std::to_string(y) + ")");
+
+    // Update the wall sensor with the new surroundings
+    bool northWall = (y == 0 || houseCopy.isWall(x, y - 1));
+    bool eastWall = (x == static_cast<int>(run.rows) - 1 || houseCopy.isWall(x + 1, y));
+    bool southWall = (y == static_cast<int>(run.cols) - 1 || houseCopy.isWall(x, y + 1));
+    bool westWall = (x == 0 || houseCopy.isWall(x - 1, y));
+    run.wallsSensor->setWalls(northWall, eastWall, southWall, westWall);
+
+    // Check if the robot is in the docking station
+    run.inDock = (run.currentPosition == run.dockingStation);
+    simulatorLogger.log(Logger::INFO, logPrefix + " In docking station: " + std::string(run.inDock ? "true" : "false"));
+
+    // Decrease the dirt level at the current position if dirt level is between 1 and 9
+    bool cleaned = false;
+    int dirt = 0;
+    char cell = houseCopy.at(x, y);
+    if (cell >= '1' && cell <= '9') {
+        dirt = cell - '0';
+        if (next == Step::Stay) {
+            dirt--;
+            run.dirtLeft--;  
+            cleaned = true;
+        }
+        houseCopy.set(x, y, (dirt > 0) ? ('0' + dirt) : '0');
+        run.dirtSensor->setDirtLevel(dirt);
+        simulatorLogger.log(Logger::INFO, logPrefix + " Cleaned dirt at position (" + std::to_string(x) + ", " + std::to_string(y) + "), new dirt level: " + std::to_string(dirt));
+    } else {
+        run.dirtSensor->setDirtLevel(0);
+    }
+
+    // Charge the battery if in the docking station and the robot stays
+    ConcreteBatteryMeter& batteryMeter = *run.batteryMeter;
+    if (run.inDock && next == Step::Stay) {
+        int chargeAmount = std::max(1, static_cast<int>(run.maxBattery / 20));
+        simulatorLogger.log(Logger::INFO, logPrefix + " Charge Amount is " + std::to_string(chargeAmount));
+        batteryMeter.setBatteryState(std::min(batteryMeter.getBatteryState() + chargeAmount, run.maxBattery));
+        simulatorLogger.log(Logger::INFO, logPrefix + " Battery charged to " + std::to_string(batteryMeter.getBatteryState()));
     } else {
+        if (batteryMeter.getBatteryState() > 0) {
+            batteryMeter.setBatteryState(batteryMeter.getBatteryState() - 1);
+        }
+        simulatorLogger.log(Logger::INFO, logPrefix + " Battery decreased to " + std::to_string(batteryMeter.getBatteryState()));
+    }
+
+    run.numSteps++;
+    if (run.liveRun) {
+        liveFeed.step(run.liveRun, run.numSteps, x, y, batteryMeter.getBatteryState(), statusName(run.status), cleaned, dirt);
+    }
+}
+
+MySimulator::SimulationResult MySimulator::finishRun(RunState& run) {
+    const std::string& algorithmName = run.algorithmName;
+    const std::string& houseName = run.houseName;
+
+    // Handle the result after the loop
+    if (run.status == RunStatus::Working) {
+        simulatorLogger.log(Logger::WARNING, "[" + algorithmName + "," + houseName + "] Algorithm ran out of steps");
+    }
+
+    int score = calculateScore(run.maxSteps, run.numSteps, run.dirtLeft, run.inDock, run.status);
+    if (run.liveRun) {
+        liveFeed.endRun(run.liveRun, statusName(run.status), run.numSteps, run.dirtLeft, score);
+    }
+
+    SimulationResult result = {houseName, algorithmName, run.numSteps, run.dirtLeft, run.inDock, run.status, score,
+                               std::move(run.stepsHistory), run.parameters};
+
+    simulatorLogger.log(Logger::INFO, "[" + algorithmName + "," + houseName + "] Recorded result for house: " + houseName + " - Score: " + std::to_string(score));
+    simulatorLogger.log(Logger::INFO, "[" + algorithmName + "," + houseName + "] Finished simulation.");
+    return result;
+}
+
+MySimulator::SimulationResult MySimulator::runSimulation(AbstractAlgorithm& algo, RunState& run) {
+    while (run.active()) {
+        Step next = algo.nextStep();  // Call the nextStep function of the algorithm
+        advanceRun(run, next);
+    }
+    return finishRun(run);
+}
+
+
+
+
+
+
+
 
-        return numSteps + dirtLeft * 300 + (inDock ? 0 : 1000);
 
+
+
+
+
+// Houses are columns and algorithm configurations rows, both in name order. The records are placed into a dense
+// table by their ids first, so writing the table does not search the results.
+void MySimulator::generateSummaryCSV() {
+
+    std::ofstream summaryFile("summary.csv");
+
+    if (!summaryFile.is_open()) {
+
+        std::cerr << "Failed to create summary.csv" << std::endl;
+
+        return;
+
+    }
+
+    constexpr std::size_t kUnused = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> houseColumn(resultHouses.size(), kUnused);
+    std::vector<std::uint32_t> houseOrder;
+    // Rows are algorithm configurations; the Parameters column only exists in a parameter sweep
+    std::map<std::pair<std::uint32_t, std::uint32_t>, std::size_t> rowOf;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> rowOrder;
+    bool hasParameters = false;
+    for (const RunRecord& result : simulationResults) {
+        if (result.empty()) {
+            continue;
+        }
+        if (houseColumn[result.houseId] == kUnused) {
+            houseColumn[result.houseId] = 0;
+            houseOrder.push_back(result.houseId);
+        }
+        if (rowOf.emplace(std::make_pair(result.algorithmId, result.parametersId), 0).second) {
+            rowOrder.emplace_back(result.algorithmId, result.parametersId);
+        }
+        hasParameters = hasParameters || !resultParameters.name(result.parametersId).empty();
+    }
+
+    std::sort(houseOrder.begin(), houseOrder.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return resultHouses.name(a) < resultHouses.name(b);
+    });
+    std::sort(rowOrder.begin(), rowOrder.end(), [&](const auto& a, const auto& b) {
+        const std::string& nameA = resultAlgorithms.name(a.first);
+        const std::string& nameB = resultAlgorithms.name(b.first);
+        return nameA != nameB ? nameA < nameB : resultParameters.name(a.second) < resultParameters.name(b.second);
+    });
+    for (std::size_t column = 0; column < houseOrder.size(); ++column) {
+        houseColumn[houseOrder[column]] = column;
+    }
+    for (std::size_t row = 0; row < rowOrder.size(); ++row) {
+        rowOf[rowOrder[row]] = row;
+    }
+
+    // The first record of a cell wins, as it always has
+    std::vector<const RunRecord*> table(rowOrder.size() * houseOrder.size(), nullptr);
+    for (const RunRecord& result : simulationResults) {
+        if (result.empty()) {
+            continue;
+        }
+        const RunRecord*& cell = table[rowOf[{result.algorithmId, result.parametersId}] * houseOrder.size() + houseColumn[result.houseId]];
+        if (!cell) {
+            cell = &result;
+        }
+    }
+
+    summaryFile << "Algorithm/House";
+    if (hasParameters) {
+        summaryFile << ",Parameters";
+    }
+    for (std::uint32_t houseId : houseOrder) {
+        summaryFile << "," << resultHouses.name(houseId);
+    }
+    summaryFile << "\n";
+
+    for (std::size_t row = 0; row < rowOrder.size(); ++row) {
+        summaryFile << resultAlgorithms.name(rowOrder[row].first);
+        if (hasParameters) {
+            summaryFile << "," << resultParameters.name(rowOrder[row].second);
+        }
+        for (std::size_t column = 0; column < houseOrder.size(); ++column) {
+            if (const RunRecord* result = table[row * houseOrder.size() + column]) {
+                summaryFile << "," << result->score;
+            } else {
+                summaryFile << ",N/A";
+            }
+        }
+        summaryFile << "\n";
     }
 
+    summaryFile.close();
+
+    std::cout << "Summary CSV generated successfully." << std::endl;
+
+}
+
+int MySimulator::calculateScore(int maxSteps, int numSteps, int dirtLeft, bool inDock, RunStatus status) {
+    simulatorLogger.log(Logger::WARNING, "[" + std::to_string(maxSteps) + "] -maxSteps");
+    simulatorLogger.log(Logger::WARNING, "[" + std::to_string(numSteps) + "] -numSteps");
+    simulatorLogger.log(Logger::WARNING, "[" + std::to_string(dirtLeft) + "] -dirtLeft");
+    simulatorLogger.log(Logger::WARNING, "[" + std::string(statusName(status)) + "] -status");
+     
+
+    return scoreRun(maxSteps, numSteps, dirtLeft, inDock, status);
+
 }
 
-void MySimulator::writeStepsHistory(const std::string& filename, const std::vector<std::tuple<std::string, std::string, std::vector<std::tuple<int, int>>, std::tuple<int, int>, int>>& simulationResults) {
+void MySimulator::writeStepsHistory(const std::string& filename, const std::vector<std::tuple<std::string, std::string, std::vector<std::tuple<int, int>>, std::tuple<int, int>, int, std::string>>& simulationResults) {
 
     std::ofstream outFile(filename);
     outFile << "[\n";
 
     for (size_t i = 0; i < simulationResults.size(); ++i) {
-        const auto& [houseName, algoName, steps, dockingStation, score] = simulationResults[i];
+        const auto& [houseName, algoName, steps, dockingStation, score, parameters] = simulationResults[i];
 
         outFile << "  {\n";
         outFile << "    \"houseName\": \"" << houseName << "\",\n";
         outFile << "    \"algorithmName\": \"" << algoName << "\",\n";
+        if (!parameters.empty()) {
+            outFile << "    \"parameters\": \"" << parameters << "\",\n";
+        }
         outFile << "    \"steps\": [\n";
 
         for (size_t j = 0; j < steps.size(); ++j) {
@@ -694,92 +2916,155 @@ void MySimulator::writeStepsHistory(const std::string& filename, const std::vect
 
 
 
-void MySimulator::writeHouseMatrix(const std::string& filename, const std::vector<std::tuple<std::string, std::vector<std::vector<char>>, int, int>>& houses) {
+// Each distinct house is written once, keyed by a hash of its contents, with its rows as strings
+// ('W' wall, '0'-'9' dirt, 'D' docking station, ' ' anything else). A house with the same dimensions
+// as an earlier one is written as the rows that differ from it when that is less than half of them,
+// and a house identical to an earlier one is only listed under "aliases".
+void MySimulator::writeHouseMatrix(const std::string& filename, const std::vector<HouseSnapshot>& houses) {
     std::ofstream outFile(filename);
 
+    auto rowText = [](const std::vector<char>& row) {
+        std::string text;
+        text.reserve(row.size());
+        for (char cell : row) {
+            if (cell == '"' || cell == '\\') {
+                text += '\\';
+            } else if (static_cast<unsigned char>(cell) < 0x20) {
+                cell = ' ';
+            }
+            text += cell;
+        }
+        return text;
+    };
+
+    std::vector<std::size_t> written; // Index into houses of every entry in the "houses" array
+    std::map<std::uint64_t, std::size_t> entryOf;
+    std::vector<std::pair<std::string, std::size_t>> aliases;
+
     outFile << "{\n";
-    outFile << "  \"houses\": [\n";
+    outFile << "  \"format\": 2,\n";
+    outFile << "  \"houses\": [";
 
-    for (size_t i = 0; i < houses.size(); ++i) {
+    for (std::size_t i = 0; i < houses.size(); ++i) {
         const auto& [houseName, houseMatrix, maxSteps, maxBattery] = houses[i];
+        std::size_t rowCount = houseMatrix.size();
+        std::size_t colCount = rowCount ? houseMatrix[0].size() : 0;
+
+        std::uint64_t hash = kFnvOffsetBasis;
+        for (std::uint64_t value : {static_cast<std::uint64_t>(maxSteps), static_cast<std::uint64_t>(maxBattery),
+                                    static_cast<std::uint64_t>(rowCount), static_cast<std::uint64_t>(colCount)}) {
+            hash = hashBytes(&value, sizeof(value), hash);
+        }
+        for (const auto& row : houseMatrix) {
+            hash = hashBytes(row.data(), row.size(), hash);
+        }
+        auto found = entryOf.find(hash);
+        if (found != entryOf.end() && std::get<1>(houses[written[found->second]]) == houseMatrix) {
+            aliases.emplace_back(houseName, found->second);
+            continue;
+        }
+
+        // The earlier house of the same size with the fewest differing rows, if that is few enough
+        std::size_t base = written.size();
+        std::size_t fewestChanged = (rowCount + 1) / 2;
+        for (std::size_t e = 0; e < written.size(); ++e) {
+            const auto& other = std::get<1>(houses[written[e]]);
+            if (other.size() != rowCount || (rowCount && other[0].size() != colCount)) {
+                continue;
+            }
+            std::size_t changed = 0;
+            for (std::size_t row = 0; row < rowCount && changed < fewestChanged; ++row) {
+                changed += other[row] != houseMatrix[row];
+            }
+            if (changed < fewestChanged) {
+                base = e;
+                fewestChanged = changed;
+            }
+        }
 
+        outFile << (written.empty() ? "\n" : ",\n");
         outFile << "    {\n";
         outFile << "      \"houseName\": \"" << houseName << "\",\n";
+        outFile << "      \"hash\": \"" << hashToHex(hash) << "\",\n";
         outFile << "      \"maxSteps\": " << maxSteps << ",\n";
         outFile << "      \"maxBattery\": " << maxBattery << ",\n";
-        outFile << "      \"house\": [\n";
-
-        for (size_t row = 0; row < houseMatrix.size(); ++row) {
-            outFile << "        [";
-            for (size_t col = 0; col < houseMatrix[row].size(); ++col) {
-                char cell = houseMatrix[row][col];
-                int cellValue;
-
-                if (cell == 'D' || cell == ' ') {
-                    cellValue = 0;
-                } else if (cell == 'W') {
-                    cellValue = -1;
-                } else if (isdigit(cell)) {
-                    cellValue = cell - '0';
-                } else {
-                    cellValue = static_cast<int>(cell);  // Fallback to ASCII value if something unexpected is encountered
-                }
-
-                outFile << cellValue;
-                if (col < houseMatrix[row].size() - 1) {
-                    outFile << ", ";
+        if (base < written.size()) {
+            const auto& baseMatrix = std::get<1>(houses[written[base]]);
+            outFile << "      \"base\": " << base << ",\n";
+            outFile << "      \"changedRows\": [";
+            bool first = true;
+            for (std::size_t row = 0; row < rowCount; ++row) {
+                if (baseMatrix[row] != houseMatrix[row]) {
+                    outFile << (first ? "\n" : ",\n") << "        [" << row << ", \"" << rowText(houseMatrix[row]) << "\"]";
+                    first = false;
                 }
             }
-            outFile << "]";
-            if (row < houseMatrix.size() - 1) {
-                outFile << ",\n";
+            outFile << (first ? "]\n" : "\n      ]\n");
+        } else {
+            outFile << "      \"rows\": [";
+            for (std::size_t row = 0; row < rowCount; ++row) {
+                outFile << (row ? ",\n" : "\n") << "        \"" << rowText(houseMatrix[row]) << "\"";
             }
+            outFile << (rowCount ? "\n      ]\n" : "]\n");
         }
-
-        outFile << "\n      ]\n";
         outFile << "    }";
-        if (i < houses.size() - 1) {
-            outFile << ",";
-        }
-        outFile << "\n";
+
+        entryOf.emplace(hash, written.size());
+        written.push_back(i);
     }
 
-    outFile << "  ]\n";
+    outFile << (written.empty() ? "],\n" : "\n  ],\n");
+    outFile << "  \"aliases\": {";
+    for (std::size_t a = 0; a < aliases.size(); ++a) {
+        outFile << (a ? ",\n" : "\n") << "    \"" << aliases[a].first << "\": " << aliases[a].second;
+    }
+    outFile << (aliases.empty() ? "}\n" : "\n  }\n");
     outFile << "}\n";
     outFile.close();
 }
-void MySimulator::writeSimulationOutput(const SimulationResult& result) {
-  // Construct the output file name based on the house and algorithm names
-   std::string outputFileName = result.houseName + "-" + result.algorithmName + ".txt";
-    
-    // Open the file for writing
-    std::ofstream outFile(outputFileName);
-    if (!outFile.is_open()) {
-        std::cerr << "Failed to open " << outputFileName << " for writing." << std::endl;
-        return;
+// Construct the output file name based on the house and algorithm names, one file per sweep configuration
+std::string MySimulator::outputFileName(const std::string& houseName, const std::string& algorithmName, const std::string& parameters) {
+    if (parameters.empty()) {
+        return houseName + "-" + algorithmName + ".txt";
     }
+    std::string suffix = parameters;
+    std::replace(suffix.begin(), suffix.end(), ';', '_');
+    return houseName + "-" + algorithmName + "-" + suffix + ".txt";
+}
+
+void MySimulator::writeSimulationOutput(const SimulationResult& result) {
+    std::string outputFileName = MySimulator::outputFileName(result.houseName, result.algorithmName, result.parameters);
+
+    // Format the whole file in memory, the output writer thread does the I/O
+    std::string contents;
+    contents.reserve(128 + result.stepsHistory.size());
+    contents += "NumSteps = " + std::to_string(result.numSteps) + "\n";
+    contents += "DirtLeft = " + std::to_string(result.dirtLeft) + "\n";
+    contents += "Status = " + std::string(statusName(result.status)) + "\n";
+    contents += std::string("InDock = ") + (result.inDock ? "TRUE" : "FALSE") + "\n";
+    contents += "Score = " + std::to_string(result.score) + "\n";
 
-    // Write the required fields to the file
-    outFile << "NumSteps = " << result.numSteps << "\n";
-    outFile << "DirtLeft = " << result.dirtLeft << "\n";
-    outFile << "Status = " << result.status << "\n";
-    outFile << "InDock = " << (result.inDock ? "TRUE" : "FALSE") << "\n";
-    outFile << "Score = " << result.score << "\n";
-    
     // Write the steps sequence
-    outFile << "Steps:\n";
+    contents += "Steps:\n";
     for (size_t i = 1; i < result.stepsHistory.size(); ++i) {
-        char direction = calculateDirectionFromSteps(result.stepsHistory[i-1], result.stepsHistory[i]);
-        outFile << direction;
+        contents += calculateDirectionFromSteps(result.stepsHistory[i-1], result.stepsHistory[i]);
     }
-    if (result.status == "FINISHED") {
-        outFile << 'F';
+    if (result.status == RunStatus::Finished) {
+        contents += 'F';
     }
-    outFile << "\n";
+    contents += "\n";
 
-    // Close the file
-    outFile.close();
-    std::cout << "Output file generated: " << outputFileName << std::endl;
+    if (outputWriter.running()) {
+        outputWriter.submit(std::move(outputFileName), std::move(contents));
+        return;
+    }
+
+    std::ofstream outFile(outputFileName);
+    if (!outFile.is_open()) {
+        std::cerr << "Failed to open " << outputFileName << " for writing." << std::endl;
+        return;
+    }
+    outFile << contents;
 }
 
 
@@ -6,19 +6,44 @@
 #include <string>
 #include <utility>
 #include <thread>
+#include <atomic>
+#include <functional>
 #include "../algorithm/Algo_Spiral/212609440_322776063_SpiralCleaningAlgorithm.h"
 #include "../algorithm/Algo_DFS/212609440_322776063_DFS.h"
 #include "../common/AlgorithmRegistrar.h"
 #include <mutex>
+#include <shared_mutex>
 #include <dlfcn.h>
 #include <fstream>
 #include <set>
+#include <map>
 #include <algorithm>
 #include "../common/ConcreteWallSensor.h"
 #include "../common/ConcreteDirtSensor.h"
 #include "../common/ConcreteBatteryMeter.h"
 #include "../common/AbstractAlgorithm.h"
+#include "../common/ParameterizedAlgorithm.h"
+#include "../common/SnapshotAlgorithm.h"
 #include "../common/Logger.h"
+#include "SharedHouseStore.h"
+#include "FileHash.h"
+#include "ParameterSweep.h"
+#include "PluginIndex.h"
+#include "OutputWriter.h"
+#include "SimulatorServer.h"
+#include "PluginWatcher.h"
+#include "LockstepBatch.h"
+#include "HouseScanner.h"
+#include "BinaryHouse.h"
+#include "LiveFeed.h"
+#include "ReplayVerifier.h"
+#include "NumaTopology.h"
+#include "TaskCostModel.h"
+#include "ResultCache.h"
+#include "RunRecord.h"
+#include "HouseBound.h"
+#include "TiledHouse.h"
+#include <filesystem>
 
 class MySimulator {
 
@@ -26,23 +51,91 @@ public:
     void run(int argc, char** argv); // Corrected run method signature
 
 private:
-    // Struct to hold the simulation results for each house-algorithm pair
+    // The full result of one house-algorithm run, as handed from the run to the output writers. It is stored
+    // as a RunRecord and a trace, see recordResult.
     struct SimulationResult {
         std::string houseName;
         std::string algorithmName;
         int numSteps;
         int dirtLeft;
         bool inDock;
-        std::string status; // "DEAD", "FINISHED", or "WORKING"
+        RunStatus status;
         int score;
         std::vector<std::tuple<int, int>> stepsHistory;
+        std::string parameters; // Sweep configuration label, empty outside of a parameter sweep
+    };
+
+    // House file, initial house matrix, maxSteps and maxBattery, as written to initial_house.json
+    using HouseSnapshot = std::tuple<std::string, std::vector<std::vector<char>>, int, int>;
+
+    // One house x algorithm run, identified by its position in the house and algorithm lists
+    struct SimulationTask {
+        std::size_t houseIndex;
+        std::size_t algorithmIndex;
+        std::size_t configIndex; // Index into the parameter sweep configurations
+    };
+
+    // Everything one simulation needs between two steps. It is copied from the loaded house when the run
+    // starts, so a run does not depend on the current-house members and runs can be advanced independently.
+    struct RunState {
+        std::string algorithmName;
+        std::string houseName;
+        std::string parameters;
+        std::string logPrefix;
+        TiledHouse house;
+        std::size_t maxSteps = 0;
+        std::size_t maxBattery = 0;
+        std::size_t rows = 0;
+        std::size_t cols = 0;
+        std::tuple<int, int> dockingStation;
+        std::tuple<int, int> currentPosition;
+        int numSteps = 0;
+        int dirtLeft = 0;
+        bool inDock = true;
+        RunStatus status = RunStatus::Working;
+        std::vector<std::tuple<int, int>> stepsHistory;
+        ConcreteWallSensor* wallsSensor = nullptr;
+        ConcreteDirtSensor* dirtSensor = nullptr;
+        ConcreteBatteryMeter* batteryMeter = nullptr;
+        std::uint64_t liveRun = 0; // Id in the live feed, 0 when the run is not followed
+
+        bool active() const { return status == RunStatus::Working && numSteps < static_cast<int>(maxSteps); }
+    };
+
+    // A run frozen after some steps, for -fork_at. The dirt is kept as the cells that differ from the house
+    // (copy-on-write against the house the run started from), the steps so far are shared by all branches.
+    struct RunSnapshot {
+        std::tuple<int, int> position;
+        std::size_t battery = 0;
+        int dirtReading = 0;
+        int numSteps = 0;
+        int dirtLeft = 0;
+        bool inDock = true;
+        RunStatus status = RunStatus::Working;
+        std::vector<std::pair<std::uint32_t, char>> dirtDelta; // Cell index (row * cols + col) and its current value
+        std::shared_ptr<const std::vector<std::tuple<int, int>>> stepsHistory;
+        std::string algorithmState; // From SnapshotAlgorithm::saveState
+    };
+
+    // A prepared task: the algorithm instance and the sensors it reads, kept next to the run state
+    struct TaskRun {
+        std::unique_ptr<AbstractAlgorithm> instance;
+        std::unique_ptr<ConcreteWallSensor> wallsSensor;
+        std::unique_ptr<ConcreteDirtSensor> dirtSensor;
+        std::unique_ptr<ConcreteBatteryMeter> batteryMeter;
+        RunState state;
+        std::size_t slot = 0;
     };
 
     // Struct to manage the loaded algorithms
     struct AlgorithmHandle {
         std::string name;
+        std::string libraryPath;
         void* handle;
         std::unique_ptr<AbstractAlgorithm> instance;
+        std::uint64_t libraryHash = 0; // Content hash of the plugin binary, part of the result cache key
+        bool parameterized = false; // Implements ParameterizedAlgorithm, so it takes part in parameter sweeps
+        bool snapshots = false; // Implements SnapshotAlgorithm, so its runs can be forked
 
         void resetInstance() {
             instance.reset();
@@ -63,25 +156,128 @@ private:
     std::size_t cols;
     std::tuple<int, int> dockingStation;
     std::tuple<int, int> currentPosition;
-    std::vector<SimulationResult> simulationResults; // Store the results of each simulation
+    // The results of a tournament, one record and one trace per (house, configuration) slot; the records refer
+    // to the names by their id in the tables below
+    std::vector<RunRecord> simulationResults;
+    std::vector<std::vector<std::tuple<int, int>>> stepsHistories;
+    NameTable resultHouses;
+    NameTable resultAlgorithms;
+    NameTable resultParameters;
     std::mutex resultsMutex; // Protect access to simulationResults
     std::mutex houseMutex;
     std::mutex algoMutex;
+    std::string sharedHouseSegment; // POSIX shm name given by -shm_houses, empty when houses are parsed per process
+    bool unlinkSharedHouses = false;
+    SharedHouseStore sharedHouses;
+    bool deterministicRun = false; // Stable input order and a run manifest, see -deterministic
+    bool seededSchedule = false;
+    std::uint64_t schedulerSeed = 0;
+    ParameterSweep parameterSweep;
+    std::string pluginIndexPath; // -plugin_index, defaults to <algo_path>/.plugin_index
+    std::size_t shardIndex = 0; // -shard=i/N, this process runs shard i of N
+    std::size_t shardCount = 1;
+    static constexpr const char* kShardHeader = "# simulator-shard v1";
+    std::string taskHistoryPath; // -task_history, defaults to ./.task_history
+    TaskCostModel costModel;
+    ResultCache resultCache; // -result_cache, disabled unless a directory is given
+    std::string outputArchivePath; // -output_archive, empty for one output file per run
+    std::string serverSocketPath; // -server, runs the simulator as a daemon on this Unix socket
+    bool keepHousesWarm = false; // Parsed houses stay in warmHouses for later runs
+    std::map<std::string, StoredHouse> warmHouses;
+    bool watchPlugins = false; // -watch, reloads changed plugins while the daemon runs
+    int watchIntervalMs = 1000;
+    bool privatePluginCopies = false; // Libraries are opened from a private copy in pluginCopyDir
+    std::string pluginCopyDir;
+    std::size_t pluginGeneration = 0;
+    std::shared_mutex algorithmsMutex; // Guards the algorithm list while plugins are reloaded
+    std::mutex pluginGatesMutex;
+    std::map<std::string, std::unique_ptr<PluginGate>> pluginGates; // Per library, never erased
+    OutputWriter outputWriter;
+    std::string liveSocketPath; // -live, stream the runs to viewers on this Unix socket
+    std::string liveFilter;
+    double liveRate = 20;
+    int liveWaitSeconds = 0;
+    LiveFeed liveFeed;
+    std::size_t raceTopK = 0; // -top_k, stop running configurations that cannot make the top K
+    std::size_t raceRoundHouses = 1; // -race_round, houses per racing round
+    bool numaPlacement = false; // -numa, pin workers to the cores of the node holding their house's replica
+    NumaTopology numaTopology;
+    std::vector<std::map<std::string, StoredHouse>> numaReplicas; // Per node, the houses whose tasks run there
+    std::size_t forkStep = 0; // -fork_at, sweep configurations branch off a shared run at this step, 0 to run them separately
+    bool lockstepBatches = false; // -lockstep, all sweep configurations of a house x algorithm pair run as one batch
+    std::size_t cooperativeRuns = 0; // -cooperative, runs interleaved per worker thread, 0 for one run at a time
+    std::size_t sweepSamples = 0;
+    std::uint64_t sweepSeed = 0;
+    std::size_t scheduledTasks = 0; // Tasks of this process after sweeps and sharding, for the run manifest
+    static bool isHouseFile(const std::filesystem::path& path);
+    static std::string outputFileName(const std::string& houseName, const std::string& algorithmName, const std::string& parameters);
+    // The label of a run that branched off a -fork_at trunk, so it is never mistaken for a full run of its configuration
+    static std::string forkedLabel(const std::string& parameters, std::size_t step) { return parameters + ";fork@" + std::to_string(step); }
+    void convertHouses(int argc, char** argv);
+    void verifyOutputs(int argc, char** argv);
+    void mergeShards(int argc, char** argv);
+    void reportBounds(int argc, char** argv);
     bool readHouseFile(const std::string& houseFilePath, std::vector<std::vector<char>>& house);
-    void setAlgorithm(AbstractAlgorithm& algo, std::vector<std::vector<char>>& house, std::tuple<int, int>& dockingStation, std::unique_ptr<ConcreteWallSensor>& wallsSensor, std::unique_ptr<ConcreteDirtSensor>& dirtSensor, std::unique_ptr<ConcreteBatteryMeter>& batteryMeter);
+    bool loadHouse(const std::string& houseFilePath, TiledHouse& house);
+    void applyHouse(const std::string& houseFilePath, const SharedHouseView& house, TiledHouse& houseCopy);
+    bool loadStoredHouse(const std::string& houseFilePath, StoredHouse& storedHouse);
+    void openSharedHouses(const std::vector<std::string>& houseFiles);
+    void setAlgorithm(AbstractAlgorithm& algo, const TiledHouse& house, std::tuple<int, int>& dockingStation, std::unique_ptr<ConcreteWallSensor>& wallsSensor, std::unique_ptr<ConcreteDirtSensor>& dirtSensor, std::unique_ptr<ConcreteBatteryMeter>& batteryMeter);
+    void loadAlgorithms(const std::string& algoPath, std::vector<AlgorithmHandle>& algorithms);
+    bool loadLibrary(const std::string& library, PluginIndex& index, std::vector<AlgorithmHandle>& algorithms);
+    void unloadAlgorithms(std::vector<AlgorithmHandle>& algorithms);
+    PluginGate& pluginGate(const std::string& library);
+    void reloadLibrary(const std::string& library, bool stillPresent, PluginIndex& index, std::vector<AlgorithmHandle>& algorithms);
+    void runServer(const std::string& housePath, const std::string& algoPath, int numThreads);
+    bool handleServerRequest(const std::string& request, const SimulatorServer::Reply& reply, SimulatorServer& server,
+                             const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms, int numThreads);
     void loadAndRunSimulations(const std::string& housePath, const std::string& algoPath, int numThreads);
+    std::vector<SimulationTask> scheduleTasks(std::size_t houseCount, const std::vector<std::pair<std::size_t, std::size_t>>& variants,
+                                              const std::vector<double>& taskCosts) const;
+    static bool readHouseShape(const std::string& houseFilePath, HouseShape& shape);
+    void writeRunManifest(const std::string& filename, const std::string& housePath, const std::string& algoPath, int numThreads,
+                          const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms);
+    void applyParameters(AbstractAlgorithm& algo, const std::string& algorithmName, const ParameterSet& parameters);
+    void raceVariants(const std::vector<std::string>& houseFiles, const std::vector<std::string>& variantNames,
+                      const std::vector<SimulationTask>& tasks, const std::vector<std::size_t>& taskVariants,
+                      const std::function<void(const std::vector<SimulationTask>&)>& executeTasks);
+    void placeHouses(const std::vector<std::string>& houseFiles, int numThreads,
+                     std::vector<std::size_t>& houseNode, std::vector<std::size_t>& nodeThreads);
     void runSimulations(const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms, int numThreads);
-    void runSimulation(const std::string& algorithmName, const std::string& houseName, 
-                                std::vector<std::vector<char>> houseCopy, AbstractAlgorithm& algo, 
-                                std::unique_ptr<ConcreteWallSensor>& wallsSensor, 
-                                std::unique_ptr<ConcreteDirtSensor>& dirtSensor, 
-                                std::unique_ptr<ConcreteBatteryMeter>& batteryMeter);
-    int calculateScore(int maxSteps, int numSteps, int dirtLeft, bool inDock, const std::string& status);
-    void generateSummaryCSV(const std::vector<SimulationResult>& results);
+    std::unique_ptr<AbstractAlgorithm> createAlgorithm(const std::string& algorithmName);
+    bool prepareTask(const std::string& houseFile, const AlgorithmHandle& algoHandle, const ParameterSet& parameters,
+                     TaskRun& run, HouseSnapshot* houseSnapshot);
+    // `elapsedSeconds`, when given, receives the time the simulation itself took, without setup and locking
+    bool runTask(const std::string& houseFile, const AlgorithmHandle& algoHandle, const ParameterSet& parameters,
+                 SimulationResult& result, HouseSnapshot* houseSnapshot, double* elapsedSeconds = nullptr);
+    bool takeSnapshot(const std::string& houseFile, const AlgorithmHandle& algoHandle, const ParameterSet& parameters,
+                      std::size_t steps, RunSnapshot& snapshot, HouseSnapshot* houseSnapshot);
+    bool forkTask(const RunSnapshot& snapshot, const std::string& houseFile, const AlgorithmHandle& algoHandle,
+                  const ParameterSet& parameters, SimulationResult& result, double* elapsedSeconds = nullptr);
+    void runCooperative(const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms,
+                        const std::vector<ParameterSet>& configurations, const std::vector<SimulationTask>& tasks,
+                        const std::vector<std::size_t>& taskSlots, std::vector<HouseSnapshot>& houses,
+                        std::atomic<std::size_t>& nextTask);
+    void runLockstep(const std::vector<std::string>& houseFiles, const std::vector<AlgorithmHandle>& algorithms,
+                     const std::vector<ParameterSet>& configurations, const std::vector<SimulationTask>& tasks,
+                     const std::vector<std::size_t>& taskSlots, std::vector<HouseSnapshot>& houses,
+                     const std::vector<std::vector<std::size_t>>& batches, std::atomic<std::size_t>& nextBatch);
+    RunState startRun(const std::string& algorithmName, const std::string& houseName, TiledHouse houseCopy,
+                      ConcreteWallSensor& wallsSensor, ConcreteDirtSensor& dirtSensor, ConcreteBatteryMeter& batteryMeter,
+                      const std::string& parameters);
+    void advanceRun(RunState& run, Step next);
+    SimulationResult finishRun(RunState& run);
+    SimulationResult runSimulation(AbstractAlgorithm& algo, RunState& run);
+    int calculateScore(int maxSteps, int numSteps, int dirtLeft, bool inDock, RunStatus status);
+    void resetResults(std::size_t slots);
+    void recordResult(std::size_t slot, SimulationResult&& result);
+    void writeResults(const std::vector<HouseSnapshot>& houses);
+    bool writeShardResults(const std::string& filename, const std::vector<HouseSnapshot>& houses);
+    void generateSummaryCSV();
     void writeSimulationOutput(const SimulationResult& result);
     char calculateDirectionFromSteps(const std::tuple<int, int>& previousPosition, const std::tuple<int, int>& currentPosition);
-    void writeHouseMatrix(const std::string& filename, const std::vector<std::tuple<std::string, std::vector<std::vector<char>>, int, int>>& houses);
-    void writeStepsHistory(const std::string& filename, const std::vector<std::tuple<std::string, std::string, std::vector<std::tuple<int, int>>, std::tuple<int, int>, int>>& simulationResults);
+    void writeHouseMatrix(const std::string& filename, const std::vector<HouseSnapshot>& houses);
+    void writeStepsHistory(const std::string& filename, const std::vector<std::tuple<std::string, std::string, std::vector<std::tuple<int, int>>, std::tuple<int, int>, int, std::string>>& simulationResults);
 };
 
 #endif // MY_SIMULATOR_H
@@ -0,0 +1,82 @@
+#include "Check.h"
+#include "../common/AlgorithmState.h"
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+ChargingPlanner plannerAfter(std::size_t steps) {
+    ChargingPlanner planner;
+    planner.setMaxSteps(100);
+    for (std::size_t i = 0; i < steps; ++i) {
+        planner.beginStep(i == 0 ? 40 : 20);
+    }
+    return planner;
+}
+
+using MapEntry = std::pair<std::tuple<int, int>, int>;
+
+void testRoundTrip() {
+    std::vector<Step> path{Step::North, Step::East, Step::Stay};
+    std::map<std::tuple<int, int>, int> map{{{1, 2}, 3}, {{-4, 5}, 0}};
+    StateWriter out("test-state-1", {7, 8}, {-1, 2}, true, plannerAfter(5));
+    out.put(Step::West).put(std::make_tuple(3, -3));
+    out.sequence(path, [&](Step step) { out.put(step); });
+    out.sequence(map, [&](const auto& entry) { out.put(entry); });
+
+    std::tuple<int, int> dock;
+    std::tuple<int, int> position;
+    bool charging = false;
+    ChargingPlanner planner;
+    planner.setMaxSteps(100);
+    StateReader in(out.str(), "test-state-1", dock, position, charging, planner);
+    CHECK(in.ok());
+    CHECK(dock == std::make_tuple(7, 8));
+    CHECK(position == std::make_tuple(-1, 2));
+    CHECK(charging);
+    CHECK(planner.capacity() == 40);
+    CHECK(planner.remainingSteps() == 96);
+
+    Step step = Step::Finish;
+    std::tuple<int, int> cell;
+    CHECK(in.get(step) && step == Step::West);
+    CHECK(in.get(cell) && cell == std::make_tuple(3, -3));
+    std::vector<Step> readPath;
+    std::map<std::tuple<int, int>, int> readMap;
+    CHECK(in.sequence<Step>([&](Step read) { readPath.push_back(read); }));
+    CHECK(in.sequence<MapEntry>([&](const auto& entry) { readMap.insert(entry); }));
+    CHECK(readPath == path);
+    CHECK(readMap == map);
+
+    // Past the end nothing more can be read
+    int extra = 0;
+    CHECK(!in.get(extra));
+    CHECK(!in.ok());
+}
+
+void testHeaderIsAppliedOnlyWhenComplete() {
+    std::tuple<int, int> dock{1, 1};
+    std::tuple<int, int> position{2, 2};
+    bool charging = false;
+    ChargingPlanner planner = plannerAfter(3);
+
+    StateWriter other("other-state-1", {7, 8}, {9, 9}, true, plannerAfter(5));
+    CHECK(!StateReader(other.str(), "test-state-1", dock, position, charging, planner).ok());
+    CHECK(!StateReader("test-state-1 7 8 9", "test-state-1", dock, position, charging, planner).ok());
+    CHECK(!StateReader("", "test-state-1", dock, position, charging, planner).ok());
+    CHECK(dock == std::make_tuple(1, 1));
+    CHECK(position == std::make_tuple(2, 2));
+    CHECK(!charging);
+    CHECK(planner.capacity() == 40);
+}
+
+}  // namespace
+
+int main() {
+    testRoundTrip();
+    testHeaderIsAppliedOnlyWhenComplete();
+    return checkResult();
+}
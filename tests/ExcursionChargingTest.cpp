@@ -0,0 +1,121 @@
+#include "Check.h"
+#include "../algorithm/Algo_DFS/212609440_322776063_DFS.h"
+#include "../algorithm/Algo_Spiral/212609440_322776063_SpiralCleaningAlgorithm.h"
+#include "../common/ConcreteBatteryMeter.h"
+#include "../common/ConcreteDirtSensor.h"
+#include "../common/ConcreteWallSensor.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Outcome {
+    bool finishedInDock = false;
+    int dirtLeft = 0;
+    std::size_t dockStays = 0;
+    // Stays the same visits to the dock would have taken to fill the battery up every time
+    std::size_t fullChargeStays = 0;
+};
+
+// The simulator's rules on a house given as rows ('W' wall, 'D' dock, digits dirt), cut down to what the
+// charging needs: a Stay in the dock charges max(1, capacity / 20), any other step costs one unit
+Outcome run(AbstractAlgorithm& algorithm, std::vector<std::string> house, std::size_t capacity, std::size_t maxSteps) {
+    int row = 0;
+    int col = 0;
+    int dirtLeft = 0;
+    for (int r = 0; r < static_cast<int>(house.size()); ++r) {
+        for (int c = 0; c < static_cast<int>(house[r].size()); ++c) {
+            char cell = house[r][c];
+            if (cell == 'D') {
+                row = r;
+                col = c;
+            } else if (cell >= '1' && cell <= '9') {
+                dirtLeft += cell - '0';
+            }
+        }
+    }
+    auto isWall = [&](int r, int c) {
+        return r < 0 || c < 0 || r >= static_cast<int>(house.size()) || c >= static_cast<int>(house[r].size()) || house[r][c] == 'W';
+    };
+    auto dirtAt = [&](int r, int c) { return house[r][c] >= '1' && house[r][c] <= '9' ? house[r][c] - '0' : 0; };
+
+    ConcreteWallSensor walls(isWall(row - 1, col), isWall(row, col + 1), isWall(row + 1, col), isWall(row, col - 1));
+    ConcreteDirtSensor dirt(0);
+    ConcreteBatteryMeter battery(capacity);
+    algorithm.setMaxSteps(maxSteps);
+    algorithm.setWallsSensor(walls);
+    algorithm.setDirtSensor(dirt);
+    algorithm.setBatteryMeter(battery);
+
+    Outcome outcome;
+    std::size_t chargePerStep = std::max<std::size_t>(1, capacity / 20);
+    bool charging = false;
+    for (std::size_t steps = 0; steps < maxSteps; ++steps) {
+        Step step = algorithm.nextStep();
+        if (step == Step::Finish) {
+            outcome.finishedInDock = house[row][col] == 'D';
+            break;
+        }
+        bool inDock = house[row][col] == 'D';
+        if (inDock && step == Step::Stay) {
+            if (!charging) {
+                outcome.fullChargeStays += (capacity - battery.getBatteryState() + chargePerStep - 1) / chargePerStep;
+                charging = true;
+            }
+            outcome.dockStays++;
+            battery.setBatteryState(std::min(capacity, battery.getBatteryState() + chargePerStep));
+        } else {
+            charging = false;
+            CHECK(battery.getBatteryState() > 0);
+            battery.setBatteryState(battery.getBatteryState() - 1);
+        }
+        switch (step) {
+            case Step::North: row--; break;
+            case Step::East:  col++; break;
+            case Step::South: row++; break;
+            case Step::West:  col--; break;
+            default:
+                if (dirtAt(row, col) > 0) {
+                    house[row][col]--;
+                    dirtLeft--;
+                }
+        }
+        CHECK(!isWall(row, col));
+        walls.setWalls(isWall(row - 1, col), isWall(row, col + 1), isWall(row + 1, col), isWall(row, col - 1));
+        dirt.setDirtLevel(dirtAt(row, col));
+    }
+    outcome.dirtLeft = dirtLeft;
+    return outcome;
+}
+
+// A corridor the first excursion explores to its end but cannot clean: the second one only has to walk it and
+// clean what is left, so it leaves the dock with less than a full battery
+const std::vector<std::string> kCorridor = {"D0099"};
+
+void testDfsChargesForTheKnownExcursion() {
+    DFSAlgorithm dfs;
+    Outcome outcome = run(dfs, kCorridor, 20, 200);
+    CHECK(outcome.finishedInDock);
+    CHECK(outcome.dirtLeft == 0);
+    CHECK(outcome.dockStays > 0);
+    CHECK(outcome.dockStays < outcome.fullChargeStays);
+}
+
+void testSpiralChargesForTheKnownExcursion() {
+    SpiralCleaningAlgorithm spiral;
+    Outcome outcome = run(spiral, kCorridor, 20, 200);
+    CHECK(outcome.finishedInDock);
+    CHECK(outcome.dirtLeft == 0);
+    CHECK(outcome.dockStays > 0);
+    CHECK(outcome.dockStays < outcome.fullChargeStays);
+}
+
+}  // namespace
+
+int main() {
+    testDfsChargesForTheKnownExcursion();
+    testSpiralChargesForTheKnownExcursion();
+    return checkResult();
+}
@@ -0,0 +1,69 @@
+#include "Check.h"
+#include "../simulator/ParameterSweep.h"
+
+#include <set>
+#include <string>
+
+namespace {
+
+ParameterSweep sweepOf(std::initializer_list<const char*> specs) {
+    ParameterSweep sweep;
+    std::string error;
+    for (const char* spec : specs) {
+        CHECK(sweep.addAxis(spec, error));
+    }
+    return sweep;
+}
+
+void testGrid() {
+    ParameterSweep sweep = sweepOf({"returnMargin:0,3", "chargeFraction:0.5,1"});
+    auto configurations = sweep.configurations();
+    CHECK(configurations.size() == 4);
+    CHECK(ParameterSweep::label(configurations.front()) == "returnMargin=0;chargeFraction=0.5");
+    CHECK(ParameterSweep::label(configurations.back()) == "returnMargin=3;chargeFraction=1");
+
+    // A value listed twice is one configuration
+    CHECK(sweepOf({"chargeFraction:0.5,0.5,1"}).configurations().size() == 2);
+    CHECK(ParameterSweep().configurations().size() == 1);
+}
+
+void testSamplesAreDistinct() {
+    // Sampling a grid of two with replacement used to repeat configurations
+    ParameterSweep lists = sweepOf({"chargeFraction:0.5,1"});
+    lists.setSamples(6, 7);
+    auto sampled = lists.configurations();
+    CHECK(sampled.size() == 2);
+    CHECK(std::set<ParameterSet>(sampled.begin(), sampled.end()).size() == sampled.size());
+
+    ParameterSweep ranges = sweepOf({"chargeFraction:0.5..0.5000001", "returnMargin:0,1"});
+    ranges.setSamples(20, 7);
+    sampled = ranges.configurations();
+    CHECK(sampled.size() == 20);
+    std::set<std::string> labels;
+    for (const auto& parameters : sampled) {
+        labels.insert(ParameterSweep::label(parameters));
+    }
+    CHECK(labels.size() == sampled.size());
+
+    // The same seed gives the same sample
+    CHECK(ranges.configurations() == sampled);
+}
+
+void testLabelRoundTrips() {
+    ParameterSet close{{"chargeFraction", 0.5}};
+    ParameterSet closer{{"chargeFraction", 0.50000000000000011}};
+    CHECK(ParameterSweep::label(close) == "chargeFraction=0.5");
+    CHECK(ParameterSweep::label(close) != ParameterSweep::label(closer));
+    std::string text = ParameterSweep::label(closer);
+    CHECK(std::stod(text.substr(text.find('=') + 1)) == closer[0].second);
+    CHECK(ParameterSweep::label({}).empty());
+}
+
+}  // namespace
+
+int main() {
+    testGrid();
+    testSamplesAreDistinct();
+    testLabelRoundTrips();
+    return checkResult();
+}
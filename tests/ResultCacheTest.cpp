@@ -0,0 +1,92 @@
+#include "Check.h"
+#include "../simulator/ResultCache.h"
+
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const std::string kDirectory = "result_cache_test";
+
+ResultCache::Key keyWith(double chargeFraction) {
+    return ResultCache::Key{0x1111, 0x2222, "DFSAlgorithm", {{"chargeFraction", chargeFraction}, {"returnMargin", 3}}, 0, {}};
+}
+
+void testRoundTrip() {
+    ResultCache cache(kDirectory);
+    ResultCache::Entry stored{42, 3, true, RunStatus::Finished, 942, 1, 2, "NNEsSWF"};
+    CHECK(cache.store(keyWith(0.5), stored));
+
+    ResultCache::Entry loaded;
+    CHECK(cache.lookup(keyWith(0.5), loaded));
+    CHECK(loaded.numSteps == 42 && loaded.dirtLeft == 3 && loaded.inDock && loaded.status == RunStatus::Finished);
+    CHECK(loaded.score == 942 && loaded.dockRow == 1 && loaded.dockCol == 2 && loaded.steps == "NNEsSWF");
+
+    CHECK(!ResultCache().lookup(keyWith(0.5), loaded));
+}
+
+void testCloseParametersAreDifferentEntries() {
+    ResultCache cache(kDirectory);
+    double next = std::nextafter(0.5, 1.0);
+    ResultCache::Entry entry;
+    CHECK(!cache.lookup(keyWith(next), entry));
+    CHECK(cache.store(keyWith(next), ResultCache::Entry{7, 0, true, RunStatus::Finished, 7, 0, 0, "EWF"}));
+    CHECK(cache.lookup(keyWith(next), entry) && entry.numSteps == 7);
+    CHECK(cache.lookup(keyWith(0.5), entry) && entry.numSteps == 42);
+}
+
+void testForkedRunsAreDifferentEntries() {
+    ResultCache cache(kDirectory);
+    ResultCache::Key forked = keyWith(0.5);
+    forked.forkStep = 100;
+    forked.trunkParameters = {{"chargeFraction", 1}, {"returnMargin", 3}};
+    ResultCache::Entry entry;
+    CHECK(!cache.lookup(forked, entry));
+    CHECK(cache.store(forked, ResultCache::Entry{5, 0, true, RunStatus::Finished, 5, 0, 0, "EWF"}));
+    CHECK(cache.lookup(forked, entry) && entry.numSteps == 5);
+    CHECK(cache.lookup(keyWith(0.5), entry) && entry.numSteps == 42);
+
+    // Branches of another trunk, or at another step, are not the same run either
+    forked.forkStep = 60;
+    CHECK(!cache.lookup(forked, entry));
+    forked.forkStep = 100;
+    forked.trunkParameters = {{"chargeFraction", 0.5}, {"returnMargin", 3}};
+    CHECK(!cache.lookup(forked, entry));
+}
+
+void testConcurrentStores() {
+    ResultCache cache(kDirectory);
+    ResultCache::Entry entry{9, 0, true, RunStatus::Finished, 9, 0, 0, "EEEEWWWWF"};
+    std::vector<int> stored(8, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < stored.size(); ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 50; ++i) {
+                stored[t] += cache.store(keyWith(0.25), entry) ? 1 : 0;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int count : stored) {
+        CHECK(count == 50);
+    }
+    ResultCache::Entry loaded;
+    CHECK(cache.lookup(keyWith(0.25), loaded) && loaded.steps == entry.steps);
+}
+
+}  // namespace
+
+int main() {
+    std::filesystem::remove_all(kDirectory);
+    testRoundTrip();
+    testCloseParametersAreDifferentEntries();
+    testForkedRunsAreDifferentEntries();
+    testConcurrentStores();
+    std::filesystem::remove_all(kDirectory);
+    return checkResult();
+}
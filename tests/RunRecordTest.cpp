@@ -0,0 +1,79 @@
+#include "Check.h"
+#include "../simulator/RunRecord.h"
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+void testNameTable() {
+    NameTable table;
+    std::uint32_t house = table.intern("house1.house");
+    std::uint32_t algorithm = table.intern("DFSAlgorithm");
+    CHECK(house == 0);
+    CHECK(algorithm == 1);
+
+    // Interning a name again returns its id; a new name gets the next one
+    CHECK(table.intern("house1.house") == house);
+    CHECK(table.intern("") == 2);
+    CHECK(table.size() == 3);
+    CHECK(table.name(house) == "house1.house");
+    CHECK(table.name(algorithm) == "DFSAlgorithm");
+    CHECK(table.name(2).empty());
+
+    table.clear();
+    CHECK(table.size() == 0);
+    CHECK(table.intern("DFSAlgorithm") == 0);
+}
+
+void testStatusRoundTrips() {
+    for (RunStatus status : {RunStatus::Working, RunStatus::Finished, RunStatus::Dead}) {
+        RunStatus parsed = RunStatus::Working;
+        CHECK(parseStatus(statusName(status), parsed));
+        CHECK(parsed == status);
+    }
+    CHECK(std::string(statusName(RunStatus::Finished)) == "FINISHED");
+
+    // Anything else is rejected and leaves the status alone
+    RunStatus status = RunStatus::Dead;
+    CHECK(!parseStatus("finished", status));
+    CHECK(!parseStatus("", status));
+    CHECK(!parseStatus("FINISHED ", status));
+    CHECK(status == RunStatus::Dead);
+}
+
+void testRecord() {
+    static_assert(std::is_trivially_copyable_v<RunRecord>);
+    CHECK(sizeof(RunRecord) == 28);
+
+    RunRecord record;
+    CHECK(record.empty());
+    CHECK(record.inDock);
+    CHECK(record.status == RunStatus::Working);
+
+    record.algorithmId = 0;
+    record.houseId = 3;
+    record.numSteps = 120;
+    record.score = 640;
+    record.status = RunStatus::Finished;
+    CHECK(!record.empty());
+
+    // Copied as raw memory, it keeps every field
+    RunRecord copy;
+    std::memcpy(&copy, &record, sizeof(RunRecord));
+    CHECK(copy.houseId == 3);
+    CHECK(copy.numSteps == 120);
+    CHECK(copy.score == 640);
+    CHECK(copy.status == RunStatus::Finished);
+    CHECK(copy.parametersId == RunRecord::kNoId);
+}
+
+}  // namespace
+
+int main() {
+    testNameTable();
+    testStatusRoundTrips();
+    testRecord();
+    return checkResult();
+}
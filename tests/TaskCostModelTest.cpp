@@ -0,0 +1,46 @@
+#include "Check.h"
+#include "../simulator/TaskCostModel.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+void testConfigurationsAreTimedApart() {
+    HouseShape house{10, 10, 100, 20, 0x1234};
+    TaskCostModel model;
+    model.record("DFSAlgorithm", "chargeFraction=0.5", house, 2.0);
+    model.record("DFSAlgorithm", "chargeFraction=1", house, 0.5);
+    CHECK(model.estimate("DFSAlgorithm", "chargeFraction=0.5", house) == 2.0);
+    CHECK(model.estimate("DFSAlgorithm", "chargeFraction=1", house) == 0.5);
+
+    // An untimed configuration is estimated from the algorithm's seconds per unit
+    double perUnit = 2.5 / (2 * TaskCostModel::sizeUnits(house));
+    HouseShape bigger{20, 20, 400, 20, 0x5678};
+    double estimate = model.estimate("DFSAlgorithm", "", bigger);
+    CHECK(estimate > perUnit * TaskCostModel::sizeUnits(bigger) * 0.999 && estimate < perUnit * TaskCostModel::sizeUnits(bigger) * 1.001);
+}
+
+void testHistoryRoundTrips() {
+    std::string path = "task_cost_model_test.history";
+    HouseShape house{5, 8, 50, 10, 0xabcdef};
+    {
+        TaskCostModel model(path);
+        model.record("SpiralCleaningAlgorithm", "", house, 0.25);
+        model.record("SpiralCleaningAlgorithm", "returnMargin=3", house, 0.75);
+        CHECK(model.save());
+    }
+    TaskCostModel loaded(path);
+    CHECK(loaded.load());
+    CHECK(loaded.estimate("SpiralCleaningAlgorithm", "", house) == 0.25);
+    CHECK(loaded.estimate("SpiralCleaningAlgorithm", "returnMargin=3", house) == 0.75);
+    std::remove(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+    testConfigurationsAreTimedApart();
+    testHistoryRoundTrips();
+    return checkResult();
+}
@@ -0,0 +1,175 @@
+#include "Check.h"
+#include "../simulator/TiledHouse.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+// 40 x 40, all wall but a room of 3 x 4 cells at rows 20-22, columns 30-33, which straddles two tiles
+std::vector<std::vector<char>> sparseHouse() {
+    std::vector<std::vector<char>> house(40, std::vector<char>(40, 'W'));
+    for (std::size_t x = 20; x <= 22; ++x) {
+        for (std::size_t y = 30; y <= 33; ++y) {
+            house[x][y] = '0';
+        }
+    }
+    house[20][30] = 'D';
+    house[22][33] = '5';
+    return house;
+}
+
+void testFromRows() {
+    auto rows = sparseHouse();
+    TiledHouse house = TiledHouse::fromRows(rows);
+    CHECK(house.rows() == 40);
+    CHECK(house.cols() == 40);
+    CHECK(house.at(20, 30) == 'D');
+    CHECK(house.at(22, 33) == '5');
+    CHECK(house.at(21, 31) == '0');
+    CHECK(house.isWall(19, 30));
+    CHECK(house.isWall(0, 0));
+    CHECK(house.isWall(39, 39));
+
+    // Short rows are padded with wall
+    TiledHouse ragged = TiledHouse::fromRows({{'D', '1', '2'}, {'3'}});
+    CHECK(ragged.cols() == 3);
+    CHECK(ragged.at(1, 0) == '3');
+    CHECK(ragged.isWall(1, 2));
+    CHECK(TiledHouse::fromRows({}).tileCount() == 0);
+}
+
+void testToRowsRoundTrips() {
+    auto rows = sparseHouse();
+    CHECK(TiledHouse::fromRows(rows).toRows() == rows);
+
+    // A house not a multiple of the tile side keeps its size
+    std::vector<std::vector<char>> odd(17, std::vector<char>(33, '1'));
+    odd[16][32] = 'D';
+    CHECK(TiledHouse::fromRows(odd).toRows() == odd);
+}
+
+void testMissingTiles() {
+    TiledHouse house = TiledHouse::fromRows(sparseHouse());
+
+    // Setting a cell of an all-wall tile is ignored; it still reads as wall
+    house.set(0, 0, '3');
+    CHECK(house.at(0, 0) == 'W');
+    house.set(39, 39, '3');
+    CHECK(house.isWall(39, 39));
+
+    // Cells of stored tiles change, on both sides of the tile border
+    house.set(21, 31, '4');
+    house.set(21, 32, '2');
+    CHECK(house.at(21, 31) == '4');
+    CHECK(house.at(21, 32) == '2');
+}
+
+void testChangedCells() {
+    TiledHouse original = TiledHouse::fromRows(sparseHouse());
+    TiledHouse house = original;
+    CHECK(house.changedCells(original).empty());
+
+    house.set(22, 33, '4');
+    house.set(21, 30, '7');
+    house.set(5, 5, '1');
+    auto changed = house.changedCells(original);
+    CHECK(changed.size() == 2);
+    bool sawDirtied = false;
+    bool sawCleaned = false;
+    for (const auto& [index, cell] : changed) {
+        sawCleaned = sawCleaned || (index == 22 * 40 + 33 && cell == '4');
+        sawDirtied = sawDirtied || (index == 21 * 40 + 30 && cell == '7');
+    }
+    CHECK(sawCleaned);
+    CHECK(sawDirtied);
+
+    // Setting a cell back to what it was is no change
+    house.set(22, 33, '5');
+    house.set(21, 30, '0');
+    CHECK(house.changedCells(original).empty());
+}
+
+void testMemoryGrowsWithFloorArea() {
+    TiledHouse house = TiledHouse::fromRows(sparseHouse());
+    // A 3 x 3 directory and the two tiles the room touches
+    CHECK(house.tileCount() == 2);
+    CHECK(house.memoryBytes() == 9 * sizeof(std::uint32_t) + 2 * TiledHouse::kTileCells);
+    CHECK(house.memoryBytes() < 40 * 40);
+
+    std::vector<std::vector<char>> walls(40, std::vector<char>(40, 'W'));
+    CHECK(TiledHouse::fromRows(walls).tileCount() == 0);
+}
+
+// Row-major cells of sparseHouse(), as the shared segment keeps them
+std::vector<char> flatCells() {
+    std::vector<char> cells;
+    for (const auto& row : sparseHouse()) {
+        cells.insert(cells.end(), row.begin(), row.end());
+    }
+    return cells;
+}
+
+void testOverlayReadsInPlace() {
+    std::vector<char> cells = flatCells();
+    TiledHouse house = TiledHouse::overlay(40, 40, cells.data());
+    CHECK(house.tileCount() == 0);
+    CHECK(house.toRows() == sparseHouse());
+    CHECK(house.at(22, 33) == '5');
+    CHECK(house.isWall(0, 0));
+
+    // A house not a multiple of the tile side reads wall past its border
+    std::vector<char> odd(17 * 33, '1');
+    TiledHouse oddHouse = TiledHouse::overlay(17, 33, odd.data());
+    CHECK(oddHouse.at(16, 32) == '1');
+    CHECK(oddHouse.isWall(17, 32));
+    CHECK(oddHouse.isWall(16, 33));
+}
+
+void testOverlayCopiesOnWrite() {
+    std::vector<char> cells = flatCells();
+    TiledHouse original = TiledHouse::overlay(40, 40, cells.data());
+    TiledHouse house = original;
+
+    // The first change to a tile copies only that tile; the stored cells stay as they were
+    house.set(22, 33, '4');
+    CHECK(house.tileCount() == 1);
+    CHECK(house.at(22, 33) == '4');
+    CHECK(house.at(21, 32) == '0');
+    CHECK(cells[22 * 40 + 33] == '5');
+    CHECK(original.at(22, 33) == '5');
+
+    // An all-wall tile is not copied and still ignores changes
+    house.set(0, 0, '3');
+    CHECK(house.isWall(0, 0));
+    CHECK(house.tileCount() == 1);
+
+    house.set(21, 30, '7');
+    CHECK(house.tileCount() == 2);
+    auto changed = house.changedCells(original);
+    CHECK(changed.size() == 2);
+    house.set(22, 33, '5');
+    house.set(21, 30, '0');
+    CHECK(house.changedCells(original).empty());
+
+    // A copy taken after a change keeps it, and is compared against tile by tile
+    house.set(20, 31, '2');
+    TiledHouse later = house;
+    later.set(20, 32, '3');
+    auto since = later.changedCells(house);
+    CHECK(since.size() == 1);
+    CHECK(!since.empty() && since[0].first == 20 * 40 + 32 && since[0].second == '3');
+}
+
+}  // namespace
+
+int main() {
+    testFromRows();
+    testToRowsRoundTrips();
+    testMissingTiles();
+    testChangedCells();
+    testMemoryGrowsWithFloorArea();
+    testOverlayReadsInPlace();
+    testOverlayCopiesOnWrite();
+    return checkResult();
+}
@@ -1,14 +1,51 @@
 import pygame
 import json
 import math
+import socket
+import sys
+
+# python3 visualize.py --live <socket> follows a running simulator started with -live=<socket>
+LIVE_SOCKET = sys.argv[sys.argv.index('--live') + 1] if '--live' in sys.argv[:-1] else None
+
+
+def load_houses(house_data):
+    # initial_house.json lists every distinct house once: rows as strings, or as the rows that changed
+    # from an earlier entry ("base"), plus the names of identical houses under "aliases".
+    # Returns one entry per house name with the matrix as ints (-1 wall, dirt level otherwise).
+    if house_data.get('format', 1) < 2:
+        unique = {}
+        for house in house_data['houses']:
+            unique.setdefault(house['houseName'], house)
+        return list(unique.values())
+
+    entries = house_data['houses']
+    rows = []
+    for entry in entries:
+        if 'base' in entry:
+            entry_rows = list(rows[entry['base']])
+            for index, text in entry['changedRows']:
+                entry_rows[index] = text
+        else:
+            entry_rows = entry['rows']
+        rows.append(entry_rows)
+
+    def decode(entry_rows):
+        return [[-1 if cell == 'W' else int(cell) if cell.isdigit() else 0 for cell in row] for row in entry_rows]
+
+    houses = [dict(entry, house=decode(rows[i])) for i, entry in enumerate(entries)]
+    for name, index in house_data.get('aliases', {}).items():
+        houses.append(dict(entries[index], houseName=name, house=decode(rows[index])))
+    return houses
+
 
-# Load data from the JSON files (steps history and the house matrix)
-with open('steps_history.json') as f:
-    steps_history = json.load(f)
-with open('initial_house.json') as f:
-    house_data = json.load(f)
+if LIVE_SOCKET is None:
+    # Load data from the JSON files (steps history and the house matrix)
+    with open('steps_history.json') as f:
+        steps_history = json.load(f)
+    with open('initial_house.json') as f:
+        house_data = json.load(f)
 
-houses = house_data['houses']
+    houses = load_houses(house_data)
 
 # Initialize Pygame
 pygame.init()
@@ -323,7 +360,7 @@ def run_all_simulations():
         if dfs_steps and spiral_steps:
             run_simulation(house, dfs_steps[0], spiral_steps[0], dfs_score, spiral_score)
         
-        current_house_index += 2
+        current_house_index += 1
 
         if current_house_index >= len(houses):
             running = False
@@ -334,4 +371,121 @@ def run_all_simulations():
 
 
 
-run_all_simulations()
\ No newline at end of file
+def live_cell(cell):
+    if cell == 'W':
+        return -1
+    return int(cell) if cell.isdigit() else 0
+
+
+def apply_live_line(line, runs):
+    parts = line.split(' ')
+    kind = parts[0]
+    if kind == 'RUN':
+        runs[parts[1]] = {
+            'rows': int(parts[2]), 'cols': int(parts[3]),
+            'dock': {'x': int(parts[4]), 'y': int(parts[5])},
+            'maxSteps': int(parts[6]), 'maxBattery': int(parts[7]),
+            'title': ' '.join(parts[8:]),
+            'house': [[0] * int(parts[3]) for _ in range(int(parts[2]))],
+            'position': (int(parts[4]), int(parts[5])),
+            'steps': 0, 'battery': int(parts[7]), 'status': 'WORKING', 'result': None,
+        }
+    elif kind == 'ROW' and parts[1] in runs:
+        cells = line.split(' ', 3)[3] if len(parts) > 3 else ''
+        row = runs[parts[1]]['house'][int(parts[2])]
+        for j, cell in enumerate(cells[:len(row)]):
+            row[j] = live_cell(cell)
+    elif kind == 'STEP' and parts[1] in runs:
+        run = runs[parts[1]]
+        run['steps'] = int(parts[2])
+        run['position'] = (int(parts[3]), int(parts[4]))
+        run['battery'] = int(parts[5])
+        run['status'] = parts[6]
+        for cell in parts[7:]:
+            x, y, dirt = (int(value) for value in cell.split(','))
+            run['house'][x][y] = dirt
+    elif kind == 'END' and parts[1] in runs:
+        runs[parts[1]]['status'] = parts[2]
+        runs[parts[1]]['result'] = f"{parts[2]}, steps {parts[3]}, dirt left {parts[4]}, score {parts[5]}"
+
+
+def draw_live_run(surface, run):
+    rows, cols = run['rows'], run['cols']
+    size = max(4, min(block_size, (surface.get_width() - 2 * margin) // max(cols, 1),
+                      (surface.get_height() - 200) // max(rows, 1)))
+    start_x = surface.get_width() // 2 - (cols * size) // 2
+    start_y = 120
+    for i in range(rows):
+        for j in range(cols):
+            level = run['house'][i][j]
+            color = WALL_COLOR if level == -1 else get_dirt_color(level)
+            pygame.draw.rect(surface, color, pygame.Rect(start_x + j * size, start_y + i * size, size, size))
+    dock = run['dock']
+    x, y = run['position']
+    draw_docking_station_symbol(surface, start_x + dock['y'] * size, start_y + dock['x'] * size, (x, y) == (dock['x'], dock['y']))
+    pygame.draw.circle(surface, GOLD, (start_x + y * size + size // 2, start_y + x * size + size // 2), max(2, size // 4))
+    draw_status(surface, run['battery'], run['maxBattery'], run['steps'], run['maxSteps'], margin, surface.get_width() - margin - 200)
+
+
+def run_live(socket_path):
+    connection = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    connection.connect(socket_path)
+    connection.setblocking(False)
+
+    pygame.init()
+    pygame.font.init()
+    window = pygame.display.set_mode((1000, 900))
+    clock = pygame.time.Clock()
+    font = pygame.font.SysFont(None, 28)
+
+    runs = {}
+    shown = None  # Follows the newest run unless one is picked with the arrow keys
+    pending = ''
+    connected = True
+    running = True
+    while running:
+        for event in pygame.event.get():
+            if event.type == pygame.QUIT:
+                running = False
+            elif event.type == pygame.KEYDOWN and runs and event.key in (pygame.K_LEFT, pygame.K_RIGHT):
+                ids = sorted(runs, key=int)
+                index = ids.index(shown) if shown in ids else len(ids) - 1
+                index = (index + (1 if event.key == pygame.K_RIGHT else -1)) % len(ids)
+                shown = ids[index]
+
+        while connected:
+            try:
+                data = connection.recv(65536)
+            except BlockingIOError:
+                break
+            if not data:
+                connected = False
+                break
+            pending += data.decode()
+            *lines, pending = pending.split('\n')
+            for line in lines:
+                if line:
+                    apply_live_line(line, runs)
+
+        window.fill(LIGHTYELLOW)
+        current = shown if shown in runs else (max(runs, key=int) if runs else None)
+        if current is None:
+            title = 'Waiting for runs...' if connected else 'Simulator disconnected'
+        else:
+            run = runs[current]
+            draw_live_run(window, run)
+            title = f"Run {current}: {run['title']}  [{run['result'] or run['status']}]"
+        window.blit(font.render(title, True, BLACK), (margin, window.get_height() - 40))
+        if not connected:
+            window.blit(font.render('Simulator disconnected', True, RED), (margin, window.get_height() - 70))
+        pygame.display.flip()
+        clock.tick(30)
+
+    connection.close()
+    pygame.quit()
+
+
+if LIVE_SOCKET is not None:
+    run_live(LIVE_SOCKET)
+else:
+    run_all_simulations()